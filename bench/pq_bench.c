@@ -0,0 +1,147 @@
+/* bench/pq_bench.c – MemQueue backends vs. the old fixed 60‑slot heap
+ *
+ *   gcc -O2 -Icore bench/pq_bench.c core/utilities.c -o pq_bench
+ *   ./pq_bench [ops]
+ *
+ * Each case fills a queue to a steady size and then times `ops` rounds of
+ * dequeue + enqueue with random priorities (0..7, like process priorities).
+ * "heap" and "bucket" are the two MemQueue backends. The old heap caps out
+ * at 60 entries, so larger sizes run on the new queue only.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "utilities.h"
+
+/* ───────── the previous heap, verbatim apart from names ───────── */
+#define OLD_QSIZE 60
+
+typedef struct {
+    PCB      *ptr;
+    int       priority;
+    uint64_t  seqno;
+} OldNode;
+
+typedef struct {
+    OldNode  items[OLD_QSIZE];
+    int      size;
+    uint64_t nextSeq;
+} OldQueue;
+
+static void old_swap(OldNode *a, OldNode *b) { OldNode t = *a; *a = *b; *b = t; }
+
+static bool old_less(const OldNode *a, const OldNode *b) {
+    if (a->priority != b->priority) return a->priority < b->priority;
+    return a->seqno < b->seqno;
+}
+
+static void old_up(OldQueue *q, int idx) {
+    if (idx == 0) return;
+    int parent = (idx - 1) / 2;
+    if (old_less(&q->items[idx], &q->items[parent])) {
+        old_swap(&q->items[idx], &q->items[parent]);
+        old_up(q, parent);
+    }
+}
+
+static void old_down(OldQueue *q, int idx) {
+    int smallest = idx, left = 2*idx + 1, right = 2*idx + 2;
+    if (left < q->size && old_less(&q->items[left], &q->items[smallest]))
+        smallest = left;
+    if (right < q->size && old_less(&q->items[right], &q->items[smallest]))
+        smallest = right;
+    if (smallest != idx) {
+        old_swap(&q->items[idx], &q->items[smallest]);
+        old_down(q, smallest);
+    }
+}
+
+static void old_enqueue(OldQueue *q, PCB *ptr, int priority) {
+    if (q->size == OLD_QSIZE) { fprintf(stderr, "PriorityQueue is full\n"); return; }
+    OldNode *n = &q->items[q->size];
+    n->ptr = ptr; n->priority = priority; n->seqno = q->nextSeq++;
+    old_up(q, q->size);
+    q->size++;
+}
+
+static PCB *old_dequeue(OldQueue *q) {
+    PCB *top = q->items[0].ptr;
+    q->items[0] = q->items[--q->size];
+    old_down(q, 0);
+    return top;
+}
+
+/* ───────── harness ───────── */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned rng = 2463534242u;
+static int rand_prio(void)
+{
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return rng & 7;
+}
+
+static volatile long sink;
+
+static double bench_old(PCB *procs, int size, long ops)
+{
+    static OldQueue q;
+    q.size = 0; q.nextSeq = 0;
+    for (int i = 0; i < size; i++) old_enqueue(&q, &procs[i], rand_prio());
+    double t0 = now_ns();
+    for (long i = 0; i < ops; i++) {
+        PCB *p = old_dequeue(&q);
+        sink += p->pid;
+        old_enqueue(&q, p, rand_prio());
+    }
+    return (now_ns() - t0) / ops;
+}
+
+static double bench_new(PCB *procs, int size, long ops, bool buckets)
+{
+    MemQueue q;
+    initQueue(&q, procs);
+    if (buckets) configureQueue(&q, 0, 7);
+    for (int i = 0; i < size; i++) enqueue(&q, &procs[i], rand_prio());
+    double t0 = now_ns();
+    for (long i = 0; i < ops; i++) {
+        PCB *p = dequeue(&q);
+        sink += p->pid;
+        enqueue(&q, p, rand_prio());
+    }
+    double ns = (now_ns() - t0) / ops;
+    freeQueue(&q);
+    return ns;
+}
+
+int main(int argc, char **argv)
+{
+    long ops = argc > 1 ? atol(argv[1]) : 5000000;
+    static const int sizes[] = { 4, 16, 60, 1000, 100000, 1000000 };
+    int maxsize = sizes[sizeof sizes / sizeof *sizes - 1];
+
+    PCB *procs = calloc(maxsize, sizeof *procs);
+    if (!procs) { perror("pq_bench"); return 1; }
+    for (int i = 0; i < maxsize; i++) procs[i].pid = i;
+
+    printf("node size: old %zu B, new %zu B\n", sizeof(OldNode), sizeof(PQNode));
+    printf("%10s %12s %12s %12s   (ns per dequeue+enqueue)\n",
+           "size", "old", "heap", "bucket");
+    for (size_t k = 0; k < sizeof sizes / sizeof *sizes; k++) {
+        int size = sizes[k];
+        double hp = bench_new(procs, size, ops, false);
+        double bk = bench_new(procs, size, ops, true);
+        if (size <= OLD_QSIZE)
+            printf("%10d %12.1f %12.1f %12.1f\n", size,
+                   bench_old(procs, size, ops), hp, bk);
+        else
+            printf("%10d %12s %12.1f %12.1f\n", size, "-", hp, bk);
+    }
+    free(procs);
+    return 0;
+}
@@ -0,0 +1,478 @@
+/* bench/sim_bench.c – engine throughput per scheduler, workload size and mix
+ *
+ *   gcc -O2 -DNDEBUG -Icore bench/sim_bench.c core/sim.c core/utilities.c \
+ *       core/old_main.c core/timing_wheel.c core/mem_alloc.c \
+ *       core/swap_file.c core/paging.c core/log.c core/histogram.c \
+ *       core/prof.c core/work_pool.c core/workload.c -pthread -lm \
+ *       -o sim_bench
+ *   ./sim_bench [-s] [-a fcfs,rr,mlfq] [-n 3,1000,...] [-m cpu,io,lock]
+ *               [-p step,run] [-c 1,128,...] [-t 1,4,...] [-l rate]
+ *               [-R reps] [-T ms] [-S steps] [-o out.json]
+ *               [-b baseline.json] [-r percent]
+ *
+ * Every case generates a workload (wgen, fixed seed; -l processes
+ * arriving per tick, default 0.1, so about one is live), loads it with
+ * sim_init and times the stepping only: "step" calls sim_step once per
+ * tick, "run" is the bulk sim_run path. A case is run -R times (default
+ * 3) in rounds; a round repeats small workloads until it has timed
+ * -T/R milliseconds (-T defaults to 200). The fastest round is reported,
+ * which keeps most host noise out of the comparison. A run stops after
+ * -S steps (default 20M) and is then reported as partial. Each case runs
+ * in a child process, so its peak RSS is its own (the generated program
+ * list included).
+ *
+ * Mixes: cpu has no I/O, io makes 30% of the instructions I/O, lock also
+ * makes half of those hold their resource (semWait/semSignal). Under RR
+ * that mix convoys: a semSignal wakes every waiter and all but one block
+ * again, a tick each, so its large cases hit the step limit.
+ *
+ * -c lists simulated core counts and -t host thread counts (both
+ * default 1); every case runs with each pair. "par" is the ticks of a
+ * run that stepped their cores in parallel (sim_set_threads), which
+ * takes 64 cores with local work in a tick.
+ *
+ * -s is the wall‑clock scaling case, short for
+ *   -a rr -m cpu -n 20000 -p run -l 20 -c 256,1024 -t 1,4
+ * (options after it override its parts): about 200 processes live, so
+ * most cores are busy on 256 and most idle on 1024, with nothing to
+ * steal. Its ticks/s shows what a tick costs per core, busy and idle,
+ * and what host threads win back.
+ *
+ * -o writes the results as JSON, one case per line; -b reads such a
+ * file and flags every case whose ticks/s fell, or whose RSS grew, by
+ * more than -r percent (default 10). The exit status is 1 if any did.
+ * bench/sim_bench_baseline.json holds a run of the defaults; numbers
+ * only compare on the same host, so record a baseline of your own with
+ * -o before changing the engine.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "sim.h"
+#include "workload.h"
+#include "log.h"
+
+#define MAX_LIST 16
+
+static const struct {
+    const char *name, *spec;
+} mixes[] = {
+    { "cpu",  "io=0,contention=0"     },
+    { "io",   "io=0.3,contention=0"   },
+    { "lock", "io=0.3,contention=0.5" },
+};
+#define NMIXES (int)(sizeof mixes / sizeof *mixes)
+
+static const char *const path_name[2] = { "step", "run" };
+
+static const char *alg_name(SCHEDULING_ALGORITHM alg)
+{
+    return alg == FCFS ? "FCFS" : alg == RR ? "RR" : "MLFQ";
+}
+
+typedef struct {
+    SCHEDULING_ALGORITHM alg;
+    long procs;
+    int  mix, path;
+    int  cores, threads;
+    double rate;                   /* arrivals per tick */
+} Case;
+
+typedef struct {
+    double min_ns;
+    long   max_steps;
+    int    reps;
+} Limits;
+
+/* ticks and steps are those of one run (they do not vary); the rates
+   come from the fastest round */
+typedef struct {
+    int    ok, complete;           /* complete: ran to the end */
+    long   runs, steps, ticks;
+    long   par_ticks;              /* ticks stepped on several threads */
+    double tps, ns_step;
+    long   rss_kb;                 /* filled in by the parent */
+} Result;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ───────── one case (in the child) ───────── */
+
+/* one timed run from sim_init on; *alive is set if it hit the step
+   limit. Returns its host time, or -1 if processes went missing. */
+static double one_run(SimContext *c, const Case *k, struct program *progs,
+                      long n, const Limits *lim, Result *r, int *alive)
+{
+    sim_init(c, progs, (int)n, k->alg, 2);
+    SimRunStats st;
+    double t0 = now_ns();
+    if (k->path == 0) {
+        st.steps = 0;
+        do {
+            *alive = sim_step(c, NULL);
+            st.steps++;
+        } while (*alive && st.steps < lim->max_steps);
+    } else {
+        *alive = sim_step_n(c, lim->max_steps, NULL, &st);
+    }
+    double ns = now_ns() - t0;
+
+    SimMetrics m;
+    sim_metrics(c, &m);
+    SimMemStats ms;
+    sim_mem_stats(c, &ms);
+    if (!*alive && m.finished + ms.rejected != n) return -1;
+    r->steps = st.steps;
+    r->ticks = m.clock;
+    r->par_ticks = m.par_ticks;
+    r->runs++;
+    return ns;
+}
+
+static Result run_case(const Case *k, const Limits *lim)
+{
+    Result r = {0};
+    char text[128];
+    snprintf(text, sizeof text, "seed=1,procs=%ld,len=4-16,rate=%g,%s",
+             k->procs, k->rate, mixes[k->mix].spec);
+    WgenSpec spec;
+    wgen_spec_default(&spec);
+    Wgen g;
+    if (wgen_spec_parse(&spec, text) || wgen_init(&g, &spec)) return r;
+
+    struct program *progs = malloc(k->procs * sizeof *progs);
+    if (!progs) { perror("sim_bench"); exit(EXIT_FAILURE); }
+    long n = 0;
+    int got;
+    while ((got = wgen_next(&g, progs + n, (int)(k->procs - n))) > 0) n += got;
+
+    SimContext *c = sim_create();
+    if (!c) exit(EXIT_FAILURE);
+    wgen_define(&g, c);
+    sim_set_io(c, NULL, NULL);
+    sim_set_cores(c, k->cores);
+    sim_set_threads(c, k->threads);
+
+    /* rounds of back‑to‑back runs, each timed as a whole so short runs
+       are not at the mercy of the clock's resolution */
+    int alive = 0;
+    for (int round = 0; round < lim->reps && !alive; round++) {
+        double timed = 0, ticks = 0, steps = 0;
+        do {
+            double ns = one_run(c, k, progs, n, lim, &r, &alive);
+            if (ns < 0) return r;
+            timed += ns;
+            ticks += r.ticks;
+            steps += r.steps;
+        } while (!alive && timed < lim->min_ns / lim->reps);
+        if (ticks / timed * 1e9 > r.tps) {
+            r.tps     = ticks / timed * 1e9;
+            r.ns_step = timed / steps;
+        }
+    }
+    r.complete = !alive;
+    r.ok = 1;
+
+    sim_destroy(c);
+    free(progs);
+    wgen_free(&g);
+    wgen_spec_free(&spec);
+    return r;
+}
+
+/* forks, runs the case and collects its result and peak RSS */
+static Result run_isolated(const Case *k, const Limits *lim)
+{
+    Result r = {0};
+    int fd[2];
+    if (pipe(fd)) { perror("sim_bench"); exit(EXIT_FAILURE); }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) { perror("sim_bench"); exit(EXIT_FAILURE); }
+    if (pid == 0) {
+        close(fd[0]);
+        Result cr = run_case(k, lim);
+        ssize_t w = write(fd[1], &cr, sizeof cr);
+        _exit(w == (ssize_t)sizeof cr ? 0 : 1);
+    }
+    close(fd[1]);
+    if (read(fd[0], &r, sizeof r) != (ssize_t)sizeof r) r.ok = 0;
+    close(fd[0]);
+
+    int status;
+    struct rusage ru;
+    if (wait4(pid, &status, 0, &ru) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status))
+        r.ok = 0;
+    r.rss_kb = ru.ru_maxrss;
+    return r;
+}
+
+/* ───────── baseline (our own -o output) ───────── */
+typedef struct {
+    char   alg[8], mix[8], path[8];
+    long   procs, rss_kb;
+    int    cores, threads;         /* 1 in files from before they existed */
+    double rate;                   /* 0.1 likewise */
+    double tps;
+} BaseRow;
+
+/* value of "key": in a one‑line JSON object; NULL if absent */
+static const char *json_field(const char *line, const char *key)
+{
+    char pat[32];
+    snprintf(pat, sizeof pat, "\"%s\":", key);
+    const char *s = strstr(line, pat);
+    return s ? s + strlen(pat) : NULL;
+}
+
+static void json_str(const char *line, const char *key, char *out, size_t len)
+{
+    const char *s = json_field(line, key);
+    size_t i = 0;
+    if (s && *s == '"')
+        for (s++; *s && *s != '"' && i + 1 < len; s++) out[i++] = *s;
+    out[i] = '\0';
+}
+
+static int read_baseline(const char *path, BaseRow **rows)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "sim_bench: cannot read baseline '%s'\n", path);
+        return -1;
+    }
+    int n = 0, cap = 0;
+    char line[512];
+    *rows = NULL;
+    while (fgets(line, sizeof line, f)) {
+        const char *procs = json_field(line, "procs");
+        const char *tps   = json_field(line, "ticks_per_s");
+        const char *rss   = json_field(line, "rss_kb");
+        const char *cores = json_field(line, "cores");
+        const char *thr   = json_field(line, "threads");
+        const char *rate  = json_field(line, "rate");
+        if (!procs || !tps || !rss) continue;
+        if (n == cap) {
+            cap = cap ? 2 * cap : 64;
+            *rows = realloc(*rows, cap * sizeof **rows);
+            if (!*rows) { perror("sim_bench"); exit(EXIT_FAILURE); }
+        }
+        BaseRow *b = &(*rows)[n++];
+        json_str(line, "alg",  b->alg,  sizeof b->alg);
+        json_str(line, "mix",  b->mix,  sizeof b->mix);
+        json_str(line, "path", b->path, sizeof b->path);
+        b->procs  = atol(procs);
+        b->tps    = atof(tps);
+        b->rss_kb = atol(rss);
+        b->cores   = cores ? atoi(cores) : 1;
+        b->threads = thr   ? atoi(thr)   : 1;
+        b->rate    = rate  ? atof(rate)  : 0.1;
+    }
+    fclose(f);
+    return n;
+}
+
+static const BaseRow *find_base(const BaseRow *rows, int n, const Case *k)
+{
+    for (int i = 0; i < n; i++)
+        if (rows[i].procs == k->procs && rows[i].cores == k->cores &&
+            rows[i].threads == k->threads && rows[i].rate == k->rate &&
+            !strcmp(rows[i].alg, alg_name(k->alg)) &&
+            !strcmp(rows[i].mix, mixes[k->mix].name) &&
+            !strcmp(rows[i].path, path_name[k->path]))
+            return &rows[i];
+    return NULL;
+}
+
+/* ───────── options ───────── */
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: sim_bench [-s] [-a fcfs,rr,mlfq] [-n sizes] [-m cpu,io,lock]\n"
+        "                 [-p step,run] [-c cores] [-t threads] [-l rate]\n"
+        "                 [-R reps] [-T ms] [-S steps] [-o out.json]\n"
+        "                 [-b baseline.json] [-r percent]\n");
+    exit(EXIT_FAILURE);
+}
+
+/* comma separated numbers in lo..hi; -1 on anything else */
+static int parse_nums(const char *arg, long lo, long hi, long *out)
+{
+    int n = 0;
+    const char *s = arg;
+    char *end;
+    while (*s && n < MAX_LIST) {
+        long v = strtol(s, &end, 10);
+        if (end == s || v < lo || v > hi || (*end && *end != ',')) return -1;
+        out[n++] = v;
+        s = *end ? end + 1 : end;
+    }
+    return n ? n : -1;
+}
+
+/* index of each comma separated name in names[]; -1 on an unknown one */
+static int parse_names(const char *arg, const char *const *names, int nnames,
+                       int *out)
+{
+    char buf[256];
+    snprintf(buf, sizeof buf, "%s", arg);
+    int n = 0;
+    for (char *t = strtok(buf, ","); t && n < MAX_LIST; t = strtok(NULL, ",")) {
+        int i = 0;
+        while (i < nnames && strcasecmp(t, names[i])) i++;
+        if (i == nnames) return -1;
+        out[n++] = i;
+    }
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const alg_names[3] = { "fcfs", "rr", "mlfq" };
+    const char *mix_names[NMIXES];
+    for (int i = 0; i < NMIXES; i++) mix_names[i] = mixes[i].name;
+
+    int  algs[MAX_LIST] = { FCFS, RR, MLFQ }, nalgs = 3;
+    int  mix[MAX_LIST]  = { 0, 1, 2 },        nmix  = NMIXES;
+    int  paths[MAX_LIST] = { 0, 1 },          npaths = 2;
+    long sizes[MAX_LIST] = { 3, 1000, 100000, 1000000 };
+    int  nsizes = 4;
+    long cores[MAX_LIST] = { 1 }, threads[MAX_LIST] = { 1 };
+    int  ncores = 1, nthreads = 1;
+    double rate = 0.1;
+    Limits lim = { 200e6, 20000000, 3 };
+    double tolerance = 10;
+    const char *out_path = NULL, *base_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "sa:n:m:p:c:t:l:R:T:S:o:b:r:h")) != -1) {
+        switch (opt) {
+        case 's':
+            algs[0] = RR;        nalgs  = 1;
+            mix[0] = 0;          nmix   = 1;
+            sizes[0] = 20000;    nsizes = 1;
+            paths[0] = 1;        npaths = 1;
+            cores[0] = 256;      cores[1] = 1024;  ncores   = 2;
+            threads[0] = 1;      threads[1] = 4;   nthreads = 2;
+            rate = 20;
+            break;
+        case 'a':
+            if ((nalgs = parse_names(optarg, alg_names, 3, algs)) <= 0) usage();
+            for (int i = 0; i < nalgs; i++)
+                algs[i] = algs[i] == 0 ? FCFS : algs[i] == 1 ? RR : MLFQ;
+            break;
+        case 'm':
+            if ((nmix = parse_names(optarg, mix_names, NMIXES, mix)) <= 0) usage();
+            break;
+        case 'p':
+            if ((npaths = parse_names(optarg, path_name, 2, paths)) <= 0) usage();
+            break;
+        case 'n':
+            if ((nsizes = parse_nums(optarg, 1, 100000000, sizes)) < 0) usage();
+            break;
+        case 'c':
+            if ((ncores = parse_nums(optarg, 1, SIM_MAX_CORES, cores)) < 0)
+                usage();
+            break;
+        case 't':
+            if ((nthreads = parse_nums(optarg, 1, 1024, threads)) < 0) usage();
+            break;
+        case 'l':
+            if ((rate = atof(optarg)) <= 0) usage();
+            break;
+        case 'R':
+            if ((lim.reps = atoi(optarg)) < 1) usage();
+            break;
+        case 'T': lim.min_ns = atof(optarg) * 1e6; break;
+        case 'S':
+            if ((lim.max_steps = atol(optarg)) < 1) usage();
+            break;
+        case 'o': out_path  = optarg;       break;
+        case 'b': base_path = optarg;       break;
+        case 'r': tolerance = atof(optarg); break;
+        default:  usage();
+        }
+    }
+
+    BaseRow *base = NULL;
+    int nbase = 0;
+    if (base_path && (nbase = read_baseline(base_path, &base)) < 0)
+        return EXIT_FAILURE;
+    FILE *out = NULL;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        fprintf(stderr, "sim_bench: cannot write '%s'\n", out_path);
+        return EXIT_FAILURE;
+    }
+    log_set_level(LOG_LEVEL_ERROR);
+
+    printf("%-5s %-5s %-4s %8s %5s %3s %12s %13s %9s %10s %8s%s\n", "alg",
+           "mix", "path", "procs", "cores", "thr", "ticks", "ticks/s",
+           "ns/step", "rss_kb", "par", base ? "  vs baseline" : "");
+    int regressions = 0, failed = 0;
+    for (int a = 0; a < nalgs; a++)
+    for (int m = 0; m < nmix; m++)
+    for (int s = 0; s < nsizes; s++)
+    for (int n = 0; n < ncores; n++)
+    for (int t = 0; t < nthreads; t++)
+    for (int p = 0; p < npaths; p++) {
+        Case k = { algs[a], sizes[s], mix[m], paths[p],
+                   (int)cores[n], (int)threads[t], rate };
+        Result r = run_isolated(&k, &lim);
+        const char *alg = alg_name(k.alg);
+        if (!r.ok) {
+            printf("%-5s %-5s %-4s %8ld %5d %3d  failed\n", alg,
+                   mixes[k.mix].name, path_name[k.path], k.procs, k.cores,
+                   k.threads);
+            failed++;
+            continue;
+        }
+        double tps = r.tps, ns_step = r.ns_step;
+        printf("%-5s %-5s %-4s %8ld %5d %3d %12ld %13.0f %9.1f %10ld %8ld",
+               alg, mixes[k.mix].name, path_name[k.path], k.procs, k.cores,
+               k.threads, r.ticks, tps, ns_step, r.rss_kb, r.par_ticks);
+        if (!r.complete) printf("  partial");
+
+        const BaseRow *b = base ? find_base(base, nbase, &k) : NULL;
+        if (b) {
+            double dt = b->tps    ? 100 * (tps / b->tps - 1) : 0;
+            double dr = b->rss_kb ? 100.0 * r.rss_kb / b->rss_kb - 100 : 0;
+            bool bad = dt < -tolerance || dr > tolerance;
+            printf("  %+6.1f%% t/s %+6.1f%% rss%s", dt, dr,
+                   bad ? "  REGRESSION" : "");
+            regressions += bad;
+        } else if (base) {
+            printf("  (no baseline)");
+        }
+        printf("\n");
+
+        if (out)
+            fprintf(out, "{\"alg\":\"%s\",\"mix\":\"%s\",\"path\":\"%s\","
+                         "\"procs\":%ld,\"cores\":%d,\"threads\":%d,"
+                         "\"rate\":%g,"
+                         "\"runs\":%ld,\"ticks\":%ld,"
+                         "\"steps\":%ld,\"ticks_per_s\":%.0f,"
+                         "\"ns_per_step\":%.2f,\"rss_kb\":%ld,"
+                         "\"par_ticks\":%ld,\"complete\":%s}\n",
+                    alg, mixes[k.mix].name, path_name[k.path], k.procs,
+                    k.cores, k.threads, k.rate, r.runs, r.ticks, r.steps, tps,
+                    ns_step, r.rss_kb, r.par_ticks,
+                    r.complete ? "true" : "false");
+    }
+    if (out) fclose(out);
+    if (base)
+        printf("%d regression%s beyond %.0f%%\n", regressions,
+               regressions == 1 ? "" : "s", tolerance);
+    free(base);
+    return regressions || failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,502 @@
+/* bench/sim_check.c – engine invariants the benches rely on
+ *
+ *   gcc -O2 -Icore bench/sim_check.c core/sim.c core/utilities.c \
+ *       core/old_main.c core/timing_wheel.c core/mem_alloc.c \
+ *       core/swap_file.c core/paging.c core/log.c core/histogram.c \
+ *       core/prof.c core/work_pool.c core/workload.c -pthread -lm \
+ *       -o sim_check
+ *   ./sim_check [-v] [-r reference.txt] [check ...]
+ *
+ * Checks (all of them by default):
+ *   delta   a view kept up to date with sim_take_deltas/sim_apply_deltas
+ *           equals the full snapshot of the same tick, queue order
+ *           included, for every scheduler, memory mode and priority
+ *           spread (a wide one puts the queues on the heap backend),
+ *           on one core and on four, taken every tick and every few
+ *           ticks, and with a pending limit small enough to force
+ *           resyncs.
+ *   reference
+ *           one core steps exactly as the engine did before it simulated
+ *           several: each case of -r (default
+ *           bench/sim_check_reference.txt, so run it from the top of the
+ *           tree) hashes every tick's processes, queues (as sets, their
+ *           listed order has changed since) and resources, and the final
+ *           per-process and run metrics, and compares that with the
+ *           digest the earlier engine produced.
+ *   threads one host thread and four step 128 simulated cores in lock
+ *           step, snapshots compared every tick and metrics at the end,
+ *           for every scheduler, with and without swapping; fails too if
+ *           no tick went parallel at all.
+ *
+ * Each case prints one line with -v; failures always do. The exit
+ * status is 1 if any case failed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "sim.h"
+#include "workload.h"
+#include "log.h"
+
+static int verbose;
+static const char *ref_path = "bench/sim_check_reference.txt";
+
+static const char *alg_name(SCHEDULING_ALGORITHM alg)
+{
+    return alg == FCFS ? "FCFS" : alg == RR ? "RR" : "MLFQ";
+}
+
+/* ───────── workloads ───────── */
+typedef struct {
+    WgenSpec spec;
+    Wgen     g;
+    struct program *progs;
+    int      n;
+} Load;
+
+static int load_init(Load *w, const char *text)
+{
+    memset(w, 0, sizeof *w);
+    wgen_spec_default(&w->spec);
+    if (wgen_spec_parse(&w->spec, text) || wgen_init(&w->g, &w->spec)) {
+        fprintf(stderr, "sim_check: bad workload '%s'\n", text);
+        return -1;
+    }
+    w->progs = malloc(w->spec.procs * sizeof *w->progs);
+    if (!w->progs) { perror("sim_check"); exit(EXIT_FAILURE); }
+    int got;
+    while ((got = wgen_next(&w->g, w->progs + w->n, w->spec.procs - w->n)) > 0)
+        w->n += got;
+    return 0;
+}
+
+static void load_free(Load *w)
+{
+    free(w->progs);
+    wgen_free(&w->g);
+    wgen_spec_free(&w->spec);
+}
+
+/* memory modes: none, contiguous with swap, paging */
+static const char *const mem_name[3] = { "plain", "swap", "paging" };
+#define SWAP_WORDS 200           /* swap mode's memory: a few images */
+
+static SimContext *engine(const Load *w, int mem, int words, int cores)
+{
+    SimContext *c = sim_create();
+    if (!c) exit(EXIT_FAILURE);
+    sim_set_io(c, NULL, NULL);
+    wgen_define(&w->g, c);
+    if (mem == 1) {
+        sim_set_memory(c, words, 0, true);
+        sim_set_swap(c, true, 3, NULL);
+    } else if (mem == 2) {
+        sim_set_paging(c, 8, 4, 2, 0, true);
+    }
+    sim_set_cores(c, cores);
+    return c;
+}
+
+/* ───────── snapshot comparison ───────── */
+
+static int same(const void *a, const void *b, size_t n)
+{
+    return !n || !memcmp(a, b, n);
+}
+
+/* first field that differs, NULL if none */
+static const char *snap_diff(const SimSnapshot *a, const SimSnapshot *b)
+{
+    if (a->clock != b->clock)                 return "clock";
+    if (a->procs_new != b->procs_new ||
+        a->procs_retired != b->procs_retired) return "process counts";
+    if (a->nproc != b->nproc ||
+        !same(a->proc, b->proc, a->nproc * sizeof *a->proc))
+        return "process table";
+    if (a->ncores != b->ncores ||
+        !same(a->running, b->running, a->ncores * sizeof *a->running))
+        return "running";
+    if (a->ready_len != b->ready_len ||
+        !same(a->ready, b->ready, a->ready_len * sizeof *a->ready))
+        return "ready queue";
+    for (int r = 0; r < NUM_RESOURCES; r++)
+        if (a->block_len[r] != b->block_len[r] ||
+            !same(a->block[r], b->block[r], a->block_len[r] * sizeof *a->block[r]))
+            return "blocked queue";
+    if (memcmp(a->res_free, b->res_free, sizeof a->res_free))
+        return "resources";
+    return NULL;
+}
+
+/* ───────── delta ───────── */
+
+/* steps the engine to the end, applying the deltas every `every` ticks
+   to a view and comparing it with that tick's full snapshot */
+static int delta_case(const Load *w, SCHEDULING_ALGORITHM alg, int mem,
+                      int cores, int every, int max_pending, const char *label)
+{
+    SimContext *c = engine(w, mem, SWAP_WORDS, cores);
+    sim_init(c, w->progs, w->n, alg, 2);
+    sim_set_deltas(c, max_pending);
+
+    SimSnapshot view = {0}, full = {0};
+    SimDeltaLog log = {0};
+    sim_take_deltas(c, &log, &view);
+    long steps = 0, applied = 0, resyncs = 0;
+    const char *bad = NULL;
+    int alive = 1;
+    while (alive && !bad) {
+        alive = sim_step(c, &full);
+        steps++;
+        if (alive && steps % every) continue;
+        sim_take_deltas(c, &log, NULL);
+        if (log.lost) {
+            sim_take_deltas(c, &log, &view);
+            resyncs++;
+        } else {
+            sim_apply_deltas(&view, &log);
+            applied += log.len;
+        }
+        bad = snap_diff(&view, &full);
+    }
+    if (bad)
+        printf("delta %s: %s differs at tick %d\n", label, bad, full.clock);
+    else if (verbose)
+        printf("delta %s: ok, %ld steps, %ld records, %ld resyncs\n",
+               label, steps, applied, resyncs);
+
+    sim_delta_log_free(&log);
+    sim_snapshot_free(&view);
+    sim_snapshot_free(&full);
+    sim_destroy(c);
+    return bad != NULL;
+}
+
+static int check_delta(void)
+{
+    static const int prios[] = { 1, 4, 100 };
+    static const struct { int every, max_pending; } takes[] = {
+        { 1, 1 << 20 }, { 7, 1 << 20 }, { 7, 16 },
+    };
+    int failed = 0;
+    for (int p = 0; p < 3; p++) {
+        char text[128];
+        snprintf(text, sizeof text, "seed=3,procs=60,prio=%d,len=4-16,"
+                 "io=0.3,contention=0.5,rate=0.3", prios[p]);
+        Load w;
+        if (load_init(&w, text)) return 1;
+        for (int a = 0; a < 3; a++)
+        for (int m = 0; m < 3; m++)
+        for (int cores = 1; cores <= 4; cores += 3)
+        for (int t = 0; t < 3; t++) {
+            SCHEDULING_ALGORITHM alg = a == 0 ? FCFS : a == 1 ? RR : MLFQ;
+            char label[96];
+            snprintf(label, sizeof label,
+                     "%s %s prio=%d cores=%d every=%d pending=%d",
+                     alg_name(alg), mem_name[m], prios[p], cores,
+                     takes[t].every, takes[t].max_pending);
+            failed += delta_case(&w, alg, m, cores, takes[t].every,
+                                 takes[t].max_pending, label);
+        }
+        load_free(&w);
+    }
+    return failed;
+}
+
+/* ───────── threads ───────── */
+
+/* steps a one-thread and a `threads` engine side by side and compares
+   every tick's snapshot, then the per-process, per-core and run
+   metrics; *par gets the ticks the second one stepped in parallel */
+static int threads_case(const Load *w, SCHEDULING_ALGORITHM alg, int mem,
+                        int cores, int threads, const char *label, long *par)
+{
+    SimContext *c[2];
+    SimSnapshot s[2] = {{0}, {0}};
+    for (int i = 0; i < 2; i++) {
+        c[i] = engine(w, mem, 6144, cores);   /* half the images fit */
+        sim_set_threads(c[i], i ? threads : 1);
+        sim_init(c[i], w->progs, w->n, alg, 2);
+    }
+    const char *bad = NULL;
+    long steps = 0;
+    int alive = 1;
+    while (alive && !bad) {
+        alive = sim_step(c[0], &s[0]);
+        if (sim_step(c[1], &s[1]) != alive) bad = "end of run";
+        else bad = snap_diff(&s[0], &s[1]);
+        steps++;
+    }
+
+    for (int pid = 0; pid < w->n && !bad; pid++) {
+        SimProcMetrics p[2];
+        memset(p, 0, sizeof p);
+        int r0 = sim_proc_metrics(c[0], pid, &p[0]);
+        int r1 = sim_proc_metrics(c[1], pid, &p[1]);
+        if (r0 != r1 || memcmp(&p[0], &p[1], sizeof *p)) bad = "process metrics";
+    }
+    SimCoreStats *ks[2];
+    for (int i = 0; i < 2; i++) {
+        ks[i] = calloc(cores, sizeof *ks[i]);
+        if (!ks[i]) { perror("sim_check"); exit(EXIT_FAILURE); }
+        sim_core_stats(c[i], ks[i], cores);
+    }
+    if (!bad && memcmp(ks[0], ks[1], cores * sizeof *ks[0])) bad = "core stats";
+    free(ks[0]);
+    free(ks[1]);
+    SimMetrics m[2];
+    memset(m, 0, sizeof m);
+    sim_metrics(c[0], &m[0]);
+    sim_metrics(c[1], &m[1]);
+    *par = m[1].par_ticks;
+    m[0].threads = m[1].threads = 0;                /* host side */
+    m[0].par_ticks = m[1].par_ticks = 0;
+    if (!bad && memcmp(&m[0], &m[1], sizeof *m)) bad = "run metrics";
+
+    if (bad)
+        printf("threads %s: %s differs at tick %d\n", label, bad, s[0].clock);
+    else if (verbose)
+        printf("threads %s: ok, %ld steps, %ld of %d ticks in parallel\n",
+               label, steps, *par, m[0].clock);
+    for (int i = 0; i < 2; i++) {
+        sim_snapshot_free(&s[i]);
+        sim_destroy(c[i]);
+    }
+    return bad != NULL;
+}
+
+static int check_threads(void)
+{
+    /* wide enough for the parallel path (64 local cores): saturated,
+       with semaphores, and fewer processes than cores */
+    static const char *const specs[] = {
+        "seed=21,procs=300,len=8-32,io=0,contention=0,rate=40",
+        "seed=22,procs=300,prio=4,len=8-32,io=0.3,contention=0.5,rate=40",
+        "seed=23,procs=110,len=16-64,io=0.1,contention=0,rate=110",
+    };
+    int failed = 0;
+    long par_total = 0;
+    for (int sp = 0; sp < 3; sp++) {
+        Load w;
+        if (load_init(&w, specs[sp])) return 1;
+        for (int a = 0; a < 3; a++)
+        for (int m = 0; m < 2; m++) {
+            SCHEDULING_ALGORITHM alg = a == 0 ? FCFS : a == 1 ? RR : MLFQ;
+            char label[128];
+            snprintf(label, sizeof label, "%s %s cores=128 threads=4 %s",
+                     alg_name(alg), mem_name[m], specs[sp]);
+            long par;
+            failed += threads_case(&w, alg, m, 128, 4, label, &par);
+            par_total += par;
+        }
+        load_free(&w);
+    }
+    if (!par_total) {
+        printf("threads: no tick stepped in parallel\n");
+        failed++;
+    }
+    return failed;
+}
+
+/* ───────── reference ───────── */
+/* FNV-1a, a 64-bit word at a time */
+static uint64_t mix(uint64_t h, long v)
+{
+    for (int i = 0; i < 8; i++) {
+        h ^= (uint64_t)v >> (8 * i) & 0xff;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+static int cmp_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* queues as sets: the order snapshots list them in is not the engine's */
+static uint64_t mix_set(uint64_t h, const int *pids, int n)
+{
+    int *tmp = malloc((n + 1) * sizeof *tmp);
+    if (!tmp) { perror("sim_check"); exit(EXIT_FAILURE); }
+    if (n) memcpy(tmp, pids, n * sizeof *tmp);
+    qsort(tmp, n, sizeof *tmp, cmp_int);
+    h = mix(h, n);
+    for (int i = 0; i < n; i++) h = mix(h, tmp[i]);
+    free(tmp);
+    return h;
+}
+
+static uint64_t mix_latency(uint64_t h, const SimLatency *l)
+{
+    h = mix(h, l->count);
+    h = mix(h, l->p50);
+    h = mix(h, l->p99);
+    h = mix(h, l->p999);
+    return mix(h, l->max);
+}
+
+/* Steps c to the end and hashes every tick's state and the final
+   per-process and run metrics, as far as the one-core engine had them. */
+static uint64_t run_digest(SimContext *c, int nprogs, long *steps)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    SimSnapshot s = {0};
+    int alive = 1;
+    for (*steps = 0; alive; ++*steps) {
+        alive = sim_step(c, &s);
+        h = mix(h, s.clock);
+        h = mix(h, s.procs_new);
+        h = mix(h, s.procs_retired);
+        h = mix(h, s.nproc);
+        for (int i = 0; i < s.nproc; i++) {
+            const SimProcInfo *p = &s.proc[i];
+            h = mix(h, p->pid);
+            h = mix(h, p->state);
+            h = mix(h, p->pc);
+            h = mix(h, p->prio);
+            h = mix(h, p->mem_lo);
+            h = mix(h, p->mem_hi);
+            h = mix(h, p->page_faults);
+            h = mix(h, p->tlb_hits);
+            h = mix(h, p->tlb_misses);
+        }
+        h = mix_set(h, s.ready, s.ready_len);
+        for (int r = 0; r < NUM_RESOURCES; r++) {
+            h = mix_set(h, s.block[r], s.block_len[r]);
+            h = mix(h, s.res_free[r]);
+        }
+    }
+    sim_snapshot_free(&s);
+
+    for (int pid = 0; pid < nprogs; pid++) {
+        SimProcMetrics p;
+        if (sim_proc_metrics(c, pid, &p)) {
+            h = mix(h, -1);
+            continue;
+        }
+        h = mix(h, p.pid);
+        h = mix(h, p.arrival);
+        h = mix(h, p.first_run);
+        h = mix(h, p.completion);
+        h = mix(h, p.cpu);
+        h = mix(h, p.ready_wait);
+        h = mix(h, p.blocked_wait);
+    }
+    SimMetrics m;
+    sim_metrics(c, &m);
+    h = mix(h, m.clock);
+    h = mix(h, m.finished);
+    h = mix(h, m.busy_ticks);
+    h = mix(h, m.context_switches);
+    h = mix_latency(h, &m.turnaround);
+    h = mix_latency(h, &m.response);
+    h = mix_latency(h, &m.ready_wait);
+    return mix_latency(h, &m.blocked_wait);
+}
+
+/* every case of the reference file on one core; a line is
+   "alg memory-mode wgen-spec digest", # starts a comment */
+static int check_reference(void)
+{
+    FILE *f = fopen(ref_path, "r");
+    if (!f) {
+        fprintf(stderr, "sim_check: cannot read '%s'\n", ref_path);
+        return 1;
+    }
+    int failed = 0, cases = 0;
+    char line[512];
+    while (fgets(line, sizeof line, f)) {
+        char alg[8], mem[8], spec[256];
+        uint64_t want;
+        if (line[0] == '#' ||
+            sscanf(line, "%7s %7s %255s %" SCNx64, alg, mem, spec, &want) != 4)
+            continue;
+        int m = 0;
+        while (m < 3 && strcasecmp(mem, mem_name[m])) m++;
+        SCHEDULING_ALGORITHM a = !strcasecmp(alg, "fcfs") ? FCFS
+                               : !strcasecmp(alg, "rr")   ? RR : MLFQ;
+        Load w;
+        if (m == 3 || load_init(&w, spec)) {
+            fprintf(stderr, "sim_check: bad reference line: %s", line);
+            failed++;
+            continue;
+        }
+        SimContext *c = engine(&w, m, SWAP_WORDS, 1);
+        sim_init(c, w.progs, w.n, a, 2);
+        long steps;
+        uint64_t got = run_digest(c, w.n, &steps);
+        if (got != want)
+            printf("reference %s %s %s: digest %016" PRIx64 ", want %016"
+                   PRIx64 "\n", alg, mem, spec, got, want);
+        else if (verbose)
+            printf("reference %s %s %s: ok, %ld steps\n", alg, mem, spec, steps);
+        failed += got != want;
+        cases++;
+        sim_destroy(c);
+        load_free(&w);
+    }
+    fclose(f);
+    if (!cases) {
+        fprintf(stderr, "sim_check: no cases in '%s'\n", ref_path);
+        failed++;
+    }
+    return failed;
+}
+
+/* ───────── driver ───────── */
+static const struct {
+    const char *name;
+    int (*run)(void);
+} checks[] = {
+    { "delta",     check_delta     },
+    { "reference", check_reference },
+    { "threads",   check_threads   },
+};
+#define NCHECKS (int)(sizeof checks / sizeof *checks)
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: sim_check [-v] [-r reference.txt] [");
+    for (int i = 0; i < NCHECKS; i++)
+        fprintf(stderr, "%s%s", i ? "|" : "", checks[i].name);
+    fprintf(stderr, "] ...\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vr:h")) != -1) {
+        switch (opt) {
+        case 'v': verbose = 1;      break;
+        case 'r': ref_path = optarg; break;
+        default:  usage();
+        }
+    }
+    int first = optind;
+    log_set_level(LOG_LEVEL_ERROR);
+
+    int wanted[NCHECKS];
+    for (int i = 0; i < NCHECKS; i++) wanted[i] = first == argc;
+    for (int j = first; j < argc; j++) {
+        int i = 0;
+        while (i < NCHECKS && strcmp(argv[j], checks[i].name)) i++;
+        if (i == NCHECKS) usage();
+        wanted[i] = 1;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < NCHECKS; i++) {
+        if (!wanted[i]) continue;
+        int f = checks[i].run();
+        printf("%-10s %s\n", checks[i].name, f ? "FAILED" : "ok");
+        failed += f;
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+/*  core/histogram.c  – log‑bucketed histogram for latency quantiles  */
+#include "histogram.h"
+
+static int bucket(int v)
+{
+    if (v < 16) return v;
+    int e = 31 - __builtin_clz((unsigned)v);     /* 4..30 */
+    return 16 + (e - 4) * HIST_SUB + ((v >> (e - 3)) & (HIST_SUB - 1));
+}
+
+/* middle of bucket i */
+static int bucket_mid(int i)
+{
+    if (i < 16) return i;
+    int e   = 4 + (i - 16) / HIST_SUB;
+    int sub = (i - 16) % HIST_SUB;
+    int lo  = (HIST_SUB + sub) << (e - 3);
+    return lo + (1 << (e - 3)) / 2;
+}
+
+void hist_add(Histogram *h, int v)
+{
+    if (v < 0) v = 0;
+    h->b[bucket(v)]++;
+    h->count++;
+    h->sum += v;
+    if (v > h->max) h->max = v;
+}
+
+int hist_quantile(const Histogram *h, double q)
+{
+    if (!h->count) return 0;
+    double r = q * h->count;
+    long rank = (long)r;
+    if (rank < r)  rank++;                       /* ceil */
+    if (rank < 1)  rank = 1;
+    long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+        if ((seen += h->b[i]) >= rank) {
+            int v = bucket_mid(i);
+            return v < h->max ? v : h->max;
+        }
+    return h->max;
+}
+
+double hist_mean(const Histogram *h)
+{
+    return h->count ? (double)h->sum / h->count : 0;
+}
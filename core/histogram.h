@@ -0,0 +1,27 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+#include <stdint.h>
+
+/*
+ * Log‑bucketed histogram of non‑negative ints (tick counts).
+ *
+ * Values below 16 get a bucket each; above that every power of two is
+ * split into 8 buckets, so a quantile is off by at most 1/16 of the value
+ * (reported at the bucket middle, never above the largest value seen).
+ * Adding is a bit scan and an increment.
+ */
+#define HIST_SUB      8                          /* buckets per power of two */
+#define HIST_BUCKETS  (16 + (31 - 4) * HIST_SUB)
+
+typedef struct {
+    long    count;
+    int64_t sum;
+    int     max;
+    long    b[HIST_BUCKETS];
+} Histogram;
+
+void   hist_add     (Histogram *h, int v);       /* v < 0 counts as 0 */
+int    hist_quantile(const Histogram *h, double q);   /* q in [0,1]; 0 if empty */
+double hist_mean    (const Histogram *h);
+
+#endif /* HISTOGRAM_H */
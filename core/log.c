@@ -0,0 +1,133 @@
+/*  core/log.c  – leveled text logs + lock‑free trace ring  */
+#include <stdarg.h>
+#include <string.h>
+#include "log.h"
+
+int log_threshold = LOG_LEVEL_INFO;
+
+void log_set_level(int level)
+{
+    log_threshold = level;
+}
+
+void log_printf(int level, const char *fmt, ...)
+{
+    static const char *tag[] = { "", "[ERROR] ", "[WARN] ", "[INFO] ", "[DEBUG] " };
+    va_list ap;
+    va_start(ap, fmt);
+    fputs(tag[level], stderr);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
+
+/* ─────── trace ring ─────── */
+volatile bool trace_on = false;
+
+static TraceEvent ring[TRACE_RING_SIZE];
+static uint64_t   ring_head;     /* next sequence number to hand out */
+
+void trace_enable(bool on)
+{
+    __atomic_store_n(&trace_on, on, __ATOMIC_RELEASE);
+}
+
+void trace_clear(void)
+{
+    __atomic_store_n(&ring_head, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Claim a slot, fill it, then publish its seq. A reader only trusts a slot
+ * whose seq matches the position it expects, so half‑written or already
+ * recycled entries are skipped instead of read torn.
+ */
+void trace_record(int sim, int clock, int kind, int pid, int a, int b)
+{
+    uint64_t seq = __atomic_fetch_add(&ring_head, 1, __ATOMIC_RELAXED);
+    TraceEvent *e = &ring[seq & (TRACE_RING_SIZE - 1)];
+
+    __atomic_store_n(&e->seq, UINT64_MAX, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    e->clock = clock;
+    e->kind  = (int16_t)kind;
+    e->sim   = (int16_t)sim;
+    e->pid   = pid;
+    e->a     = a;
+    e->b     = b;
+    __atomic_store_n(&e->seq, seq, __ATOMIC_RELEASE);
+}
+
+size_t trace_copy(TraceEvent *out, size_t max)
+{
+    uint64_t head  = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    uint64_t first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+    if (head - first > max) first = head - max;
+
+    size_t n = 0;
+    for (uint64_t s = first; s < head; s++) {
+        const TraceEvent *e = &ring[s & (TRACE_RING_SIZE - 1)];
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != s) continue;
+        TraceEvent copy = *e;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) != s) continue;
+        out[n++] = copy;
+    }
+    return n;
+}
+
+size_t trace_read(uint64_t *next, TraceEvent *out, size_t max, uint64_t *lost)
+{
+    uint64_t head  = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    uint64_t first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+    uint64_t s     = *next;
+    if (s < first) {
+        if (lost) *lost += first - s;
+        s = first;
+    }
+
+    size_t n = 0;
+    for (; s < head && n < max; s++) {
+        const TraceEvent *e = &ring[s & (TRACE_RING_SIZE - 1)];
+        uint64_t at = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+        if (at == UINT64_MAX || at < s) break;      /* still being written */
+        TraceEvent copy = *e;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (at != s || __atomic_load_n(&e->seq, __ATOMIC_RELAXED) != s) {
+            if (lost) (*lost)++;                    /* recycled meanwhile */
+            continue;
+        }
+        out[n++] = copy;
+    }
+    *next = s;
+    return n;
+}
+
+const char *trace_kind_name(int kind)
+{
+    switch (kind) {
+        case TR_ARRIVE:    return "arrive";
+        case TR_DISPATCH:  return "dispatch";
+        case TR_EXEC:      return "exec";
+        case TR_PREEMPT:   return "preempt";
+        case TR_BLOCK:     return "block";
+        case TR_WAKE:      return "wake";
+        case TR_EXIT:      return "exit";
+        case TR_IDLE_SKIP: return "idle_skip";
+        case TR_COMPACT:   return "compact";
+        case TR_SWAP_OUT:  return "swap_out";
+        case TR_SWAP_IN:   return "swap_in";
+        case TR_PAGE_FAULT:return "page_fault";
+        case TR_MIGRATE:   return "migrate";
+        default:           return "?";
+    }
+}
+
+void trace_dump(FILE *f)
+{
+    static TraceEvent buf[TRACE_RING_SIZE];
+    size_t n = trace_copy(buf, TRACE_RING_SIZE);
+    for (size_t i = 0; i < n; i++)
+        fprintf(f, "sim%-3d %8d %-9s pid=%d a=%d b=%d\n",
+                buf[i].sim, buf[i].clock, trace_kind_name(buf[i].kind),
+                buf[i].pid, buf[i].a, buf[i].b);
+}
@@ -0,0 +1,104 @@
+#ifndef LOG_H
+#define LOG_H
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Logging in two parts:
+ *
+ *  1. Text logs (LOG_ERROR .. LOG_DEBUG). Anything above SIM_LOG_LEVEL is
+ *     compiled out, so release builds (-DNDEBUG) keep only errors. Debug
+ *     builds compile everything in but print only up to the runtime
+ *     threshold (log_set_level, default LOG_LEVEL_INFO).
+ *
+ *  2. A trace ring of fixed‑size scheduling events. Recording is off until
+ *     trace_enable(true); when off a TRACE() costs one relaxed load. Writers
+ *     never take a lock, and a full ring overwrites its oldest entries.
+ */
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef SIM_LOG_LEVEL
+#  ifdef NDEBUG
+#    define SIM_LOG_LEVEL LOG_LEVEL_ERROR
+#  else
+#    define SIM_LOG_LEVEL LOG_LEVEL_DEBUG
+#  endif
+#endif
+
+#ifndef SIM_TRACE
+#  define SIM_TRACE 1
+#endif
+
+extern int log_threshold;
+void log_set_level(int level);
+void log_printf(int level, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#define LOG_AT(level, ...)                                              \
+    do {                                                                \
+        if ((level) <= SIM_LOG_LEVEL && (level) <= log_threshold)       \
+            log_printf((level), __VA_ARGS__);                           \
+    } while (0)
+
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN,  __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO,  __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+/* ——— structured trace ——— */
+typedef enum {
+    TR_ARRIVE,      /* a = memory lower bound */
+    TR_DISPATCH,    /* a = queue level (MLFQ) or 0, b = core */
+    TR_EXEC,        /* a = pc before the instruction, b = opcode */
+    TR_PREEMPT,     /* a = queue level it goes back to */
+    TR_BLOCK,       /* a = resource */
+    TR_WAKE,        /* a = resource */
+    TR_EXIT,
+    TR_IDLE_SKIP,   /* pid = -1, a = clock jumped to */
+    TR_COMPACT,     /* pid = -1, a = words in use, b = images moved over */
+    TR_SWAP_OUT,    /* a = swap slot, b = words freed */
+    TR_SWAP_IN,     /* a = new memory lower bound, b = tick it can run */
+    TR_PAGE_FAULT,  /* a = pc, b = 1 if the instruction waits for it */
+    TR_MIGRATE      /* a = core it leaves, b = core that stole it */
+} TraceKind;
+
+typedef struct {
+    uint64_t seq;   /* position in the stream; lets readers spot overwrites */
+    int32_t  clock;
+    int16_t  kind;
+    int16_t  sim;   /* id of the SimContext that recorded it */
+    int32_t  pid;
+    int32_t  a, b;
+} TraceEvent;
+
+#define TRACE_RING_SIZE 65536   /* power of two */
+
+extern volatile bool trace_on;
+void   trace_enable(bool on);
+void   trace_clear(void);
+void   trace_record(int sim, int clock, int kind, int pid, int a, int b);
+size_t trace_copy(TraceEvent *out, size_t max);   /* oldest first */
+/* Drains the ring: copies up to max events from sequence *next on and
+   moves *next past them. Events already overwritten are skipped and
+   added to *lost (may be NULL). Call it often enough to keep up. */
+size_t trace_read(uint64_t *next, TraceEvent *out, size_t max, uint64_t *lost);
+void   trace_dump(FILE *f);
+const char *trace_kind_name(int kind);
+
+#if SIM_TRACE
+#  define TRACE(sim, clock, kind, pid, a, b)                                      \
+       do {                                                                        \
+           if (__atomic_load_n(&trace_on, __ATOMIC_RELAXED))                       \
+               trace_record((sim), (clock), (kind), (pid), (a), (b));              \
+       } while (0)
+#else
+#  define TRACE(sim, clock, kind, pid, a, b) do { } while (0)
+#endif
+
+#endif /* LOG_H */
@@ -0,0 +1,260 @@
+/*  core/mem_alloc.c  – first/best fit and buddy allocation of word ranges  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mem_alloc.h"
+
+const char *alloc_policy_name(AllocPolicy p)
+{
+    switch (p) {
+    case ALLOC_FIRST_FIT: return "first-fit";
+    case ALLOC_BEST_FIT:  return "best-fit";
+    case ALLOC_BUDDY:     return "buddy";
+    }
+    return "?";
+}
+
+static void *xrealloc(void *p, size_t n)
+{
+    p = realloc(p, n);
+    if (!p) { perror("mem_alloc"); exit(EXIT_FAILURE); }
+    return p;
+}
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* ───────── fit policies: address‑ordered free blocks ───────── */
+static void fit_insert_at(MemAllocator *a, int i, int start, int len)
+{
+    if (a->nblocks == a->cap_blocks) {
+        a->cap_blocks = a->cap_blocks ? 2 * a->cap_blocks : 16;
+        a->blocks = xrealloc(a->blocks, a->cap_blocks * sizeof *a->blocks);
+    }
+    memmove(&a->blocks[i + 1], &a->blocks[i],
+            (a->nblocks - i) * sizeof *a->blocks);
+    a->blocks[i] = (FreeBlock){ start, len };
+    a->nblocks++;
+}
+
+static void fit_remove_at(MemAllocator *a, int i)
+{
+    memmove(&a->blocks[i], &a->blocks[i + 1],
+            (a->nblocks - i - 1) * sizeof *a->blocks);
+    a->nblocks--;
+}
+
+static int fit_take(MemAllocator *a, int words)
+{
+    int pick = -1;
+    for (int i = 0; i < a->nblocks; i++) {
+        int len = a->blocks[i].len;
+        if (len < words) continue;
+        if (a->policy == ALLOC_FIRST_FIT) { pick = i; break; }
+        if (pick < 0 || len < a->blocks[pick].len) {
+            pick = i;
+            if (len == words) break;
+        }
+    }
+    if (pick < 0) return -1;
+
+    FreeBlock *b = &a->blocks[pick];
+    int addr = b->start;
+    b->start += words;
+    b->len   -= words;
+    if (!b->len) fit_remove_at(a, pick);
+    return addr;
+}
+
+static void fit_give(MemAllocator *a, int addr, int words)
+{
+    /* first block above addr */
+    int lo = 0, hi = a->nblocks;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (a->blocks[mid].start < addr) lo = mid + 1;
+        else                             hi = mid;
+    }
+    FreeBlock *prev = lo > 0           ? &a->blocks[lo - 1] : NULL;
+    FreeBlock *next = lo < a->nblocks  ? &a->blocks[lo]     : NULL;
+    bool join_prev = prev && prev->start + prev->len == addr;
+    bool join_next = next && addr + words == next->start;
+
+    if (join_prev && join_next) {
+        prev->len += words + next->len;
+        fit_remove_at(a, lo);
+    } else if (join_prev) {
+        prev->len += words;
+    } else if (join_next) {
+        next->start = addr;
+        next->len  += words;
+    } else {
+        fit_insert_at(a, lo, addr, words);
+    }
+}
+
+/* ───────── buddy: one free list per order, units of BUDDY_MIN_WORDS ───────── */
+static int buddy_order(int words)
+{
+    int k = 0;
+    while ((BUDDY_MIN_WORDS << k) < words) k++;
+    return k;
+}
+
+static void buddy_push(MemAllocator *a, int u, int k)
+{
+    a->next[u] = a->head[k];
+    a->prev[u] = -1;
+    if (a->head[k] >= 0) a->prev[a->head[k]] = u;
+    a->head[k] = u;
+    a->order_of[u] = (int8_t)k;
+    a->free_count++;
+}
+
+static void buddy_unlink(MemAllocator *a, int u, int k)
+{
+    if (a->prev[u] >= 0) a->next[a->prev[u]] = a->next[u];
+    else                 a->head[k] = a->next[u];
+    if (a->next[u] >= 0) a->prev[a->next[u]] = a->prev[u];
+    a->order_of[u] = -1;
+    a->free_count--;
+}
+
+static int buddy_take(MemAllocator *a, int words)
+{
+    int k = buddy_order(words), j = k;
+    while (j <= a->max_order && a->head[j] < 0) j++;
+    if (j > a->max_order) return -1;
+
+    int u = a->head[j];
+    buddy_unlink(a, u, j);
+    while (j > k) {                    /* split, keep the lower half */
+        j--;
+        buddy_push(a, u + (1 << j), j);
+    }
+    return u * BUDDY_MIN_WORDS;
+}
+
+static void buddy_give(MemAllocator *a, int addr, int words)
+{
+    int k = buddy_order(words), u = addr / BUDDY_MIN_WORDS;
+    while (k < a->max_order) {
+        int b = u ^ (1 << k);
+        if (a->order_of[b] != k) break;
+        buddy_unlink(a, b, k);
+        if (b < u) u = b;
+        k++;
+    }
+    buddy_push(a, u, k);
+}
+
+/* ───────── public ───────── */
+void alloc_init(MemAllocator *a, int capacity, AllocPolicy policy)
+{
+    memset(a, 0, sizeof *a);
+    a->policy = policy;
+    if (capacity < BUDDY_MIN_WORDS) capacity = BUDDY_MIN_WORDS;
+
+    if (policy == ALLOC_BUDDY) {
+        int units = capacity / BUDDY_MIN_WORDS;
+        while ((2 << a->max_order) <= units) a->max_order++;
+        units = 1 << a->max_order;
+        a->capacity = units * BUDDY_MIN_WORDS;
+        a->next     = malloc(units * sizeof *a->next);
+        a->prev     = malloc(units * sizeof *a->prev);
+        a->order_of = malloc(units * sizeof *a->order_of);
+        if (!a->next || !a->prev || !a->order_of) {
+            perror("mem_alloc");
+            exit(EXIT_FAILURE);
+        }
+        memset(a->order_of, -1, units);
+        for (int k = 0; k < 32; k++) a->head[k] = -1;
+        buddy_push(a, 0, a->max_order);
+    } else {
+        a->capacity = capacity;
+        fit_insert_at(a, 0, 0, capacity);
+    }
+}
+
+void alloc_destroy(MemAllocator *a)
+{
+    free(a->blocks);
+    free(a->next);
+    free(a->prev);
+    free(a->order_of);
+    memset(a, 0, sizeof *a);
+}
+
+int alloc_block_words(const MemAllocator *a, int words)
+{
+    if (a->policy == ALLOC_BUDDY) return BUDDY_MIN_WORDS << buddy_order(words);
+    return words;
+}
+
+int alloc_take(MemAllocator *a, int words)
+{
+    if (words <= 0 || words > a->capacity) {
+        a->st.failures++;
+        return -1;
+    }
+    long t0 = now_ns();
+    int addr = a->policy == ALLOC_BUDDY ? buddy_take(a, words)
+                                        : fit_take(a, words);
+    long dt = now_ns() - t0;
+
+    a->st.alloc_ns_total += dt;
+    if (dt > a->st.alloc_ns_max) a->st.alloc_ns_max = dt;
+    if (addr < 0) {
+        a->st.failures++;
+        return -1;
+    }
+    a->st.allocs++;
+    a->st.in_use    += alloc_block_words(a, words);
+    a->st.requested += words;
+    return addr;
+}
+
+void alloc_give(MemAllocator *a, int addr, int words)
+{
+    if (a->policy == ALLOC_BUDDY) buddy_give(a, addr, words);
+    else                          fit_give(a, addr, words);
+    a->st.frees++;
+    a->st.in_use    -= alloc_block_words(a, words);
+    a->st.requested -= words;
+}
+
+void alloc_compacted(MemAllocator *a, int used_top)
+{
+    if (a->policy == ALLOC_BUDDY) return;
+    a->nblocks = 0;
+    if (used_top < a->capacity)
+        fit_insert_at(a, 0, used_top, a->capacity - used_top);
+}
+
+long alloc_free_words(const MemAllocator *a)
+{
+    return a->capacity - a->st.in_use;
+}
+
+int alloc_largest_free(const MemAllocator *a)
+{
+    if (a->policy == ALLOC_BUDDY) {
+        for (int k = a->max_order; k >= 0; k--)
+            if (a->head[k] >= 0) return BUDDY_MIN_WORDS << k;
+        return 0;
+    }
+    int best = 0;
+    for (int i = 0; i < a->nblocks; i++)
+        if (a->blocks[i].len > best) best = a->blocks[i].len;
+    return best;
+}
+
+int alloc_free_blocks(const MemAllocator *a)
+{
+    return a->policy == ALLOC_BUDDY ? a->free_count : a->nblocks;
+}
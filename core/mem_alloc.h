@@ -0,0 +1,77 @@
+#ifndef MEM_ALLOC_H
+#define MEM_ALLOC_H
+/*
+ * Allocator for the simulated word address space that process images are
+ * placed in. Addresses are plain word indices; no memory is behind them.
+ *
+ *  - first fit / best fit keep an address‑ordered array of free blocks and
+ *    coalesce neighbours on free. They can be compacted by the caller,
+ *    which relocates the live blocks and then calls alloc_compacted().
+ *  - buddy rounds every request up to a power of two (at least
+ *    BUDDY_MIN_WORDS) and merges buddies on free; it is never compacted.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    ALLOC_FIRST_FIT,
+    ALLOC_BEST_FIT,
+    ALLOC_BUDDY
+} AllocPolicy;
+
+#define BUDDY_MIN_WORDS 16
+
+typedef struct {
+    int start, len;
+} FreeBlock;
+
+typedef struct {
+    long allocs, frees, failures;
+    long in_use;              /* words handed out, rounding included */
+    long requested;           /* words asked for by live allocations */
+    long alloc_ns_total;      /* host time spent in alloc_take() */
+    long alloc_ns_max;
+} AllocStats;
+
+typedef struct {
+    AllocPolicy policy;
+    int         capacity;     /* usable words (buddy: a power of two) */
+
+    /* fit policies */
+    FreeBlock  *blocks;       /* sorted by start, never adjacent */
+    int         nblocks, cap_blocks;
+
+    /* buddy: per‑order free lists threaded through unit indices */
+    int         max_order;
+    int         head[32];
+    int        *next, *prev;
+    int8_t     *order_of;     /* order of the free block starting here, or -1 */
+    int         free_count;   /* free buddy blocks */
+
+    AllocStats  st;
+} MemAllocator;
+
+void alloc_init(MemAllocator *a, int capacity, AllocPolicy policy);
+void alloc_destroy(MemAllocator *a);
+
+/* address of a fresh block of `words`, or -1 if no free block is large
+   enough right now */
+int  alloc_take(MemAllocator *a, int words);
+/* give back a block obtained with alloc_take(a, words) */
+void alloc_give(MemAllocator *a, int addr, int words);
+
+/* words the policy really reserves for a request */
+int  alloc_block_words(const MemAllocator *a, int words);
+
+/* fit policies only: the caller has packed all live blocks into
+   [0, used_top); everything above becomes one free block */
+void alloc_compacted(MemAllocator *a, int used_top);
+
+/* free‑space shape */
+long alloc_free_words(const MemAllocator *a);
+int  alloc_largest_free(const MemAllocator *a);
+int  alloc_free_blocks(const MemAllocator *a);
+
+const char *alloc_policy_name(AllocPolicy p);
+
+#endif /* MEM_ALLOC_H */
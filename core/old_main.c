@@ -8,205 +8,365 @@
 
 #include <pthread.h>
 #include "sim.h"
+#include "sim_internal.h"
+#include "log.h"
 
-/* these *must* match whatever your old code used */
-struct program *g_plist = NULL;
-int            g_plen  = 0;
-
-
-
-#define MAX_PROGRAMS  100
-int curr_level[MAX_PROGRAMS];
-int rem_quantum[MAX_PROGRAMS];
-
-int MemorySize = 150;
-
-static int PCBID = 0; // a global counter of Process IDs in order to be tracked globally in other words ID to be used by next process initiated   
-
-SCHEDULING_ALGORITHM algo;
-
-//makes memory globally accessible:
-extern struct MemoryWord *Memory_start_location;
-//  struct MemoryWord *Program_start_locations[MAX_PROGRAMS] = {0};
-
-// initializnig global queues for simple access
-MemQueue readyQueueNotPtr;
-MemQueue *readyQueue  ;
-
-// MemQueue BlockingQueuesNotPtrs[NUM_RESOURCES];
-// MemQueue *BlockingQueues[NUM_RESOURCES];
-
-
-
-// MLFQ queues need global access since we need to enqueue from blocking queues into them
-
-MemQueue MLFQ_queues_not_ptrs[4];
-MemQueue *MLFQ_queues[4];
-
-
-
-// // initializing the array to have 3 resources, and so that with the enum i can point to the corresponding resource in a readable format 
-// bool Resources_availability[NUM_RESOURCES] = {true,true,true};   
+/*
+ * The interpreter keeps no state of its own: the process table, program
+ * images, queues, resources and program I/O all come from the SimContext
+ * it is handed, so any number of simulations can run at once.
+ */
 
-// // structs defining the MemoryWord layout
-// struct program{
-//     char programName[50];
-//     int priority;
-//     int arrivalTime;
-// };
+void dumpMemory(SimContext *c) {
+    struct MemoryWord words[64];
 
+    printf("── Memory Dump ───────────────────────────\n");
+    for (int i = 0; i < c->act_len; i++) {
+        const PCB *pcb = &c->procs[c->active[i]];
+        if (pcb->state == TERMINATED) continue;
+        int n = render_process(c, pcb, words, 64);
+        for (int i = 0; i < n; i++) {
+            struct MemoryWord *w = &words[i];
+            if (atoi(w->arg1) == 0)
+                printf("[%d]: id=\"%s\", arg1=\"%s\", arg2=%d\n",
+                       pcb->mem_lo + i, w->identifier, w->arg1, w->arg2);
+            else
+                printf("[%d]: id=\"%s\", arg1=\"%d\", arg2=%d\n",
+                       pcb->mem_lo + i, w->identifier, atoi(w->arg1), w->arg2);
+        }
+    }
+    printf("───────────────────────────────────────────\n\n");
+}
 
 
-struct MemoryWord * createMemory(){
+/* ─────── decoder: text line → Instruction (runs once per line at load) ─────── */
 
+static Resources parse_resource(const char *tok)
+{
+    if (tok && strcmp(tok, "userInput") == 0)  return USER_INPUT;
+    if (tok && strcmp(tok, "userOutput") == 0) return USER_OUTPUT;
+    if (tok && strcmp(tok, "file") == 0)       return FILE_ACCESS;
+    perror("invalid resource allocation request");
+    exit(EXIT_FAILURE);
+}
 
-    // creating program memory
-    struct MemoryWord *arr = calloc(MemorySize, sizeof *arr);
-    Memory_start_location = arr;
-    if (!arr){
-        perror("failed to create memory ");
+// returns the slot holding `name`, creating it when `define` is set
+static int var_slot(char names[NUM_VAR_SLOTS][100], int *nvars,
+                    const char *name, bool define)
+{
+    for (int i = 0; i < *nvars; i++)
+        if (strcmp(names[i], name) == 0)
+            return i;
+    if (!define) return -1;
+    if (*nvars == NUM_VAR_SLOTS) {
+        fprintf(stderr, "Error: no place in memory for variables\n");
         exit(EXIT_FAILURE);
     }
-
-    return arr;
+    strncpy(names[*nvars], name, 99);
+    names[*nvars][99] = '\0';
+    return (*nvars)++;
 }
 
-/* core/sim.c */
-static struct program *plist;   /* set once in sim_init() */
-static int  plen;
-
-/* global clock & “all done?” */
-static int  clk;
-static int  finished;
-
-/* algorithm‑specific state */
-static struct {
-    /* FCFS & RR */    MemQueue ready;
-    /* RR only  */     int current_quanta; struct MemoryWord *running;
-    /* MLFQ only*/     MemQueue q[4];      int curr_level[MAX_PROGRAMS];
-} s;
-
-/* ---------------------------------------------------- */
-static void step_fcfs(void);
-static void step_rr(void);
-static void step_mlfq(void);
+static void decode_operand(Operand *o, const char *tok,
+                           char names[NUM_VAR_SLOTS][100], int *nvars)
+{
+    o->slot = -1;
+    o->ival = 0;
+    o->text = NULL;
+    if (!tok) return;
+    o->slot = var_slot(names, nvars, tok, false);
+    o->ival = atoi(tok);
+    o->text = strdup(tok);
+}
 
+static void decode_instruction(const char *line, Instruction *in,
+                               char names[NUM_VAR_SLOTS][100], int *nvars)
+{
+    char buffer[100];
+    strncpy(buffer, line, sizeof buffer - 1);
+    buffer[sizeof buffer - 1] = '\0';
 
+    memset(in, 0, sizeof *in);
+    in->a.slot = in->b.slot = -1;
 
+    char *save;
+    char *cmd = strtok_r(buffer, " \n", &save);
+    char *t1  = strtok_r(NULL, " \n", &save);
+    char *t2  = strtok_r(NULL, " \n", &save);
 
-void dumpMemory(struct MemoryWord *memory) {
-    printf("── Memory Dump ───────────────────────────\n");
-    for (int i = 0; i < MemorySize; i++) {
-        if (atoi(memory[i].arg1) == 0)
-        printf("[%d]: id=\"%s\", arg1=\"%s\", arg2=%d\n",
-               i,
-               memory[i].identifier,
-               memory[i].arg1,
-               memory[i].arg2);
-        else
-            printf("[%d]: id=\"%s\", arg1=\"%d\", arg2=%d\n",
-                i,
-                memory[i].identifier,
-                memory[i].arg1,
-                memory[i].arg2);
+    if (strcmp(cmd, "assign") == 0) {
+        if (!t1 || !t2) {
+            perror("error in assign statement syntax");
+            exit(EXIT_FAILURE);
+        }
+        if (strcmp(t2, "input") == 0) {
+            in->op = OP_ASSIGN_INPUT;
+        } else if (strcmp(t2, "readFile") == 0) {
+            char *fv = strtok_r(NULL, " \n", &save);
+            if (!fv) {
+                fprintf(stderr, "Syntax error: missing filename or variable name\n");
+                exit(EXIT_FAILURE);
+            }
+            in->op = OP_ASSIGN_READFILE;
+            decode_operand(&in->b, fv, names, nvars);
+        } else {
+            in->op = OP_ASSIGN;
+            char *endptr;
+            long ival = strtol(t2, &endptr, 10);
+            size_t rlen = strlen(t2);
+            if (*endptr == '\0') {
+                in->b.ival = (int)ival;
+                in->b.text = strdup(t2);
+            } else if (rlen >= 2 && t2[0] == '\"' && t2[rlen-1] == '\"') {
+                t2[rlen-1] = '\0';
+                in->b.text = strdup(t2 + 1);
+            }
+            /* anything else leaves b.text NULL: the assignment is a no‑op */
+        }
+        /* the target is bound after the rhs so `assign a a` reads the old a */
+        in->a.slot = var_slot(names, nvars, t1, true);
+        in->a.text = strdup(t1);
+    } else if (strcmp(cmd, "print") == 0) {
+        in->op = OP_PRINT;
+        decode_operand(&in->a, t1, names, nvars);
+    } else if (strcmp(cmd, "writeFile") == 0) {
+        in->op = OP_WRITEFILE;
+        decode_operand(&in->a, t1, names, nvars);
+        decode_operand(&in->b, t2, names, nvars);
+    } else if (strcmp(cmd, "readFile") == 0) {
+        in->op = OP_READFILE;
+    } else if (strcmp(cmd, "printFromTo") == 0) {
+        in->op = OP_PRINT_FROM_TO;
+        decode_operand(&in->a, t1, names, nvars);
+        decode_operand(&in->b, t2, names, nvars);
+    } else if (strcmp(cmd, "semWait") == 0) {
+        in->op  = OP_SEM_WAIT;
+        in->res = parse_resource(t1);
+    } else if (strcmp(cmd, "semSignal") == 0) {
+        in->op  = OP_SEM_SIGNAL;
+        in->res = parse_resource(t1);
+    } else {
+        perror("command entered is not proper!!");
+        exit(EXIT_FAILURE);
     }
-    
-    printf("───────────────────────────────────────────\n\n");
 }
 
+static void free_program_code(Instruction *code)
+{
+    if (!code) return;
+    for (Instruction *in = code; ; in++) {
+        free(in->a.text);
+        free(in->b.text);
+        if (in->op == OP_EOI) break;
+    }
+    free(code);
+}
 
-void parseProgram(char *filename, struct MemoryWord *memory) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
-        exit(EXIT_FAILURE);
+void free_images(SimContext *c)
+{
+    for (int i = 0; i < c->nimages; i++) {
+        free_program_code(c->images[i].code);
+        free(c->images[i].text);
+        free(c->images[i].line);
     }
+    free(c->images);
+    c->images = NULL;
+    c->nimages = c->images_cap = 0;
+}
 
-    memory += 8;  // skip first 8 words (reserved for PCB)
+/*
+ * Compiles every line of a program once into an Instruction and keeps
+ * the source text for display. The code array is terminated by OP_EOI.
+ */
+static void parse_stream(FILE *file, const char *filename, ProgramImage *img) {
     char line[100];
     int index = 0;
 
+    int   cap  = 64;                  // lines; doubled as needed
+    Instruction *code = calloc(cap + 1, sizeof *code);
+    int  *offs = malloc(cap * sizeof *offs);
+    char *text = malloc(cap * sizeof line);
+    int   used = 0;
+    char names[NUM_VAR_SLOTS][100];
+    int  nvars = 0;
+
     while (fgets(line, sizeof(line), file)) {
         char *trimmed = trim(line);
         if (strlen(trimmed) == 0) continue; // skip empty lines
 
-        if (index >= 60 - 8) { // protect memory overflow
-            fprintf(stderr, "Error: Program too large for memory\n");
-            exit(EXIT_FAILURE);
+        if (!code || !offs || !text) break;
+        if (index == cap) {
+            cap *= 2;
+            code = realloc(code, (cap + 1) * sizeof *code);
+            offs = realloc(offs, cap * sizeof *offs);
+            text = realloc(text, cap * sizeof line);
+            if (!code || !offs || !text) break;
+            memset(code + index, 0, (cap + 1 - index) * sizeof *code);
         }
 
-        strncpy(memory[index].identifier, trimmed, sizeof(memory[index].identifier) - 1);
-        memory[index].identifier[sizeof(memory[index].identifier) - 1] = '\0';  // null-terminate
+        size_t len = strlen(trimmed);
+        offs[index] = used;
+        memcpy(text + used, trimmed, len + 1);
+        used += (int)len + 1;
+
+        decode_instruction(trimmed, &code[index], names, &nvars);
 
         index++;
     }
 
+    if (!code || !offs || !text) {
+        perror("parseProgram");
+        exit(EXIT_FAILURE);
+    }
+
     // Add EOI marker
-    strcpy(memory[index].identifier, "EOI");
+    code[index].op = OP_EOI;
+    code[index].a.slot = code[index].b.slot = -1;
+
+    snprintf(img->name, sizeof img->name, "%s", filename);
+    img->code   = code;
+    img->ninstr = index;
+    img->text   = realloc(text, used ? used : 1);
+    img->line   = offs;
+}
 
+void parseProgram(const char *filename, ProgramImage *img) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    parse_stream(file, filename, img);
     fclose(file);
 }
 
+// decoded image of a program, loading it on first use: text registered
+// with sim_define_program first, else the file of that name
+static int load_image(SimContext *c, const char *filename)
+{
+    for (int i = 0; i < c->nimages; i++)
+        if (strcmp(c->images[i].name, filename) == 0)
+            return i;
+    if (c->nimages == c->images_cap) {
+        c->images_cap = c->images_cap ? 2 * c->images_cap : 8;
+        c->images = realloc(c->images, c->images_cap * sizeof *c->images);
+        if (!c->images) {
+            perror("load_image");
+            exit(EXIT_FAILURE);
+        }
+    }
+    const char *src = program_source(c, filename);
+    if (src) {
+        FILE *file = fmemopen((void *)src, strlen(src), "r");
+        if (!file) {
+            perror("load_image");
+            exit(EXIT_FAILURE);
+        }
+        parse_stream(file, filename, &c->images[c->nimages]);
+        fclose(file);
+    } else {
+        parseProgram(filename, &c->images[c->nimages]);
+    }
+    return c->nimages++;
+}
 
+// text of the instruction a process is about to execute
+static const char *instr_text(const SimContext *c, const PCB *p)
+{
+    const ProgramImage *img = &c->images[p->image];
+    return p->pc < img->ninstr ? img->text + img->line[p->pc] : "EOI";
+}
 
-// creating the PCB
-
-void createPCB(struct MemoryWord *memory, int priority){
-
-    /*
-    PCB is made up of 5 consecutive words for the following attributes:
-        1.Process ID (depends on the global counter)
-        2. Process state (states are: new, ready, running, waiting (blocked), terminated )
-        3. current priority (initialzed with supplied memory address)
-        4. Program counter (initialized with supplied memory address )
-        5. Memory boundaries // fixed at supplied memory location for start, and supplied mem location + number of instructions + 1 (EOI) + 5 (PCB) + (number of variables)
-    */
-    
+static const char *var_text(const VarSlot *v)
+{
+    return v->heap ? v->heap : v->text;
+}
 
-    int i = 0;
+void free_vars(PCB *p)
+{
+    for (int i = 0; i < NUM_VAR_SLOTS; i++) {
+        free(p->vars[i].heap);
+        memset(&p->vars[i], 0, sizeof p->vars[i]);
+    }
+}
 
-    // finding EOI
 
-    // Process ID
-    strcpy(memory[i].identifier, "ID");
-    sprintf(memory[i].arg1, "%d", PCBID++);
-    
-    // Process State
-    i++;
-    strcpy(memory[i].identifier, "State");
-    sprintf(memory[i].arg1, "%d", NEW);
-    
-    // Priority
-    i++;
-    strcpy(memory[i].identifier, "Current_priority");
-    sprintf(memory[i].arg1, "%d", priority);
-    
-    // Program Counter
-    i++;
-    strcpy(memory[i].identifier, "Program_counter");
-    sprintf(memory[i].arg1, "%d", 0);
-    
-    // Memory Boundaries
-    i++;
-    strcpy(memory[i].identifier, "Memory_Bounds");
-    sprintf(memory[i].arg1, "%d",memory - Memory_start_location );           // Lower bound 
 
-    int j=0;
-    while (strcmp(memory[j].identifier, "EOI") != 0) j++;   // get location of last instruction
+// creating the PCB
 
-    memory[i].arg2 =   memory + j - Memory_start_location;       // Upper bound
+/*
+    Renders a process image as the old word layout, for display only:
+        0. Process ID
+        1. Process state (states are: new, ready, running, waiting (blocked), terminated )
+        2. current priority
+        3. Program counter
+        4. Memory boundaries (lower bound in arg1, upper bound in arg2)
+        5..7 variables (name, value) once assigned
+        8..  program text, then "EOI"
+    Writes at most `max` words and returns how many were written.
+*/
+int render_process(const SimContext *c, const PCB *p,
+                   struct MemoryWord *out, int max){
+    const ProgramImage *img = &c->images[p->image];
+    int n = 8 + img->ninstr + 1;
+    if (n > max) n = max;
+    memset(out, 0, n * sizeof *out);
+
+    struct MemoryWord word[5];
+    memset(word, 0, sizeof word);
+    strcpy(word[0].identifier, "ID");
+    sprintf(word[0].arg1, "%d", p->pid);
+    strcpy(word[1].identifier, "State");
+    sprintf(word[1].arg1, "%d", p->state);
+    strcpy(word[2].identifier, "Current_priority");
+    sprintf(word[2].arg1, "%d", p->priority);
+    strcpy(word[3].identifier, "Program_counter");
+    sprintf(word[3].arg1, "%d", p->pc);
+    strcpy(word[4].identifier, "Memory_Bounds");
+    sprintf(word[4].arg1, "%d", p->mem_lo);             // Lower bound
+    word[4].arg2 = p->mem_hi;                            // Upper bound
+
+    for (int i = 0; i < n; i++) {
+        struct MemoryWord *w = &out[i];
+        if (i < 5) {
+            *w = word[i];
+        } else if (i < 8) {
+            const VarSlot *v = &p->vars[i - FIRST_VAR_SLOT];
+            if (!v->set) continue;
+            // the variable's name is the target of the assign that set it
+            for (const Instruction *in = img->code; in->op != OP_EOI; in++)
+                if ((in->op == OP_ASSIGN || in->op == OP_ASSIGN_INPUT ||
+                     in->op == OP_ASSIGN_READFILE) && in->a.slot == i - FIRST_VAR_SLOT) {
+                    snprintf(w->identifier, sizeof w->identifier, "%s", in->a.text);
+                    break;
+                }
+            snprintf(w->arg1, sizeof w->arg1, "%s", var_text(v));
+        } else if (i - 8 < img->ninstr) {
+            snprintf(w->identifier, sizeof w->identifier, "%s",
+                     img->text + img->line[i - 8]);
+        } else {
+            strcpy(w->identifier, "EOI");
+        }
+    }
+    return n;
 }
 
-
-// this method looks in the memory for a variable and returns its offset in memory from beginning of program
-int lookupValue(struct MemoryWord *memory, const char *var) {
-    for (int i = 5; i < 8; i++) {
-        char *entry = memory[i].identifier;
-        if (strcmp( memory[i].identifier, var) == 0){
-            return i ;
-        }
-    }            
-    return -1;
+PCB *createPCB(SimContext *c, int image, int priority, int mem_lo){
+    PCB *p = &c->procs[c->next_pid];
+    const ProgramImage *img = &c->images[image];
+
+    memset(p, 0, sizeof *p);
+    p->pid      = c->next_pid++;
+    p->state    = NEW;
+    p->priority = priority;
+    p->pc       = 0;
+    p->image    = image;
+    p->code     = img->code;
+
+    // bounds: 8 header words, the program text, then the EOI word
+    p->mem_lo  = mem_lo;
+    p->mem_hi  = p->mem_lo + 8 + img->ninstr;
+    return p;
 }
 
 
@@ -232,152 +392,91 @@ char *getFileContent(const char *filename) {
 }
 
 
-void assignValue(char * line, struct MemoryWord *memory){
-    char *lhs = strtok(NULL, " \n");
-    char *rhs = strtok(NULL, " \n");
-    if (!lhs || !rhs ) {
-        perror("error in assign statement syntax");
-        exit(EXIT_FAILURE);
+// value of an operand: the variable's contents once it has been assigned, else the literal token
+static const char *operand_text(const PCB *p, const Operand *o)
+{
+    if (o->slot >= 0 && p->vars[o->slot].set)
+        return var_text(&p->vars[o->slot]);
+    return o->text;
+}
+
+static int operand_int(const PCB *p, const Operand *o)
+{
+    if (o->slot >= 0 && p->vars[o->slot].set)
+        return p->vars[o->slot].ival;
+    return o->ival;
+}
+
+// stores `value` into the variable slot of an assign's target
+static void store_variable(PCB *p, const Operand *target, const char *value)
+{
+    VarSlot *v = &p->vars[target->slot];
+    size_t len = strlen(value);
+    if (len > 99) len = 99;          // same limit as the old 100‑byte word
+
+    free(v->heap);
+    v->heap = NULL;
+    if (len < VAR_INLINE) {
+        memcpy(v->text, value, len);
+        v->text[len] = '\0';
+    } else {
+        v->heap = strndup(value, len);
     }
+    v->len  = (uint8_t)len;
+    v->ival = atoi(value);
+    v->set  = 1;
+}
 
-    if (strcmp(rhs, "input") == 0) {
-        // 1) find free slot in memory[5..7]
-        int slot = -1;
-        for (int j = 5; j < 8; ++j) {
-            if (memory[j].identifier[0] == '\0') {
-                slot = j;
-                break;
-            }
-        }
-        if (slot < 0) {
-            fprintf(stderr, "Error: no place in memory for variables\n");
-            exit(EXIT_FAILURE);
-        }
-    
-        // 2) record the variable name
-        strncpy(memory[slot].identifier, lhs,
-                sizeof memory[slot].identifier - 1);
-        memory[slot].identifier[
-            sizeof memory[slot].identifier - 1] = '\0';
-    
-        // 3) prompt and read entire line, including spaces
-        printf("Enter the value of %s:\n", lhs);
+void assignValue(SimContext *c, const Instruction *in, PCB *p){
+    if (in->op == OP_ASSIGN_INPUT) {
+        // prompt and read entire line, including spaces
+        if (c->out) fprintf(c->out, "Enter the value of %s:\n", in->a.text);
         char buf[200];
-        if (!fgets(buf, sizeof buf, stdin)) {
-            perror("input");
-            exit(EXIT_FAILURE);
+        if (!c->in || !fgets(buf, sizeof buf, c->in)) {
+            // out of input: keep running with an empty value
+            LOG_WARN("no input left for %s\n", in->a.text);
+            buf[0] = '\0';
         }
         // strip trailing newline
         buf[strcspn(buf, "\n")] = '\0';
-    
-        // 4) store verbatim in memory slot
-        strncpy(memory[slot].arg1, buf,
-                sizeof memory[slot].arg1 - 1);
-        memory[slot].arg1[
-            sizeof memory[slot].arg1 - 1] = '\0';
-    }else if (strcmp(rhs, "readFile") == 0) {
-        char *fv = strtok(NULL, " \n");
-        if (!fv) {
-            fprintf(stderr, "Syntax error: missing filename or variable name\n");
-            exit(EXIT_FAILURE);
-        }
-    
+        store_variable(p, &in->a, buf);
+    } else if (in->op == OP_ASSIGN_READFILE) {
         char tmp[100] = {0};
-        FILE *file = fopen(fv, "r");
-    
+        FILE *file = fopen(in->b.text, "r");
+
         if (file) {
-            // Happy case: `fv` is a direct filename
+            // Happy case: the token is a direct filename
             if (fgets(tmp, sizeof tmp, file)) {
                 tmp[strcspn(tmp, "\n")] = '\0';
             }
             fclose(file);
         } else {
-            // Try treating `fv` as a variable name
-            int floc = lookupValue(memory, fv);
-            if (floc < 0) {
-                fprintf(stderr, "Error: '%s' is neither a file nor a valid variable\n", fv);
-                exit(EXIT_FAILURE);
-            }
-    
-            char *fname = memory[floc].arg1;
-    
-    
-            FILE *fi = fopen(fname, "r");
-            if (!fi) {
-                fprintf(stderr, "Error: cannot open file '%s'\n", fname);
-                exit(EXIT_FAILURE);
+            // Try treating the token as a variable name
+            // a bad name is the simulated program's fault, not the host's:
+            // report it and leave the variable empty
+            FILE *fi = NULL;
+            if (in->b.slot < 0 || !p->vars[in->b.slot].set) {
+                LOG_ERROR("'%s' is neither a file nor a valid variable\n", in->b.text);
+            } else if (!(fi = fopen(var_text(&p->vars[in->b.slot]), "r"))) {
+                LOG_ERROR("cannot open file '%s'\n", var_text(&p->vars[in->b.slot]));
             }
-    
-            if (fgets(tmp, sizeof tmp, fi)) {
-                tmp[strcspn(tmp, "\n")] = '\0';
-            }
-            fclose(fi);
-        }
-    
-        // Store the result in the next free memory slot [5..7]
-        int slot = -1;
-        for (int i = 5; i < 8; i++) {
-            if (memory[i].identifier[0] == '\0') {
-                slot = i;
-                break;
-            }
-        }
-    
-        if (slot < 0) {
-            fprintf(stderr, "Error: no free memory slot available\n");
-            exit(EXIT_FAILURE);
-        }
-    
-        strcpy(memory[slot].identifier, lhs);
-        strcpy(memory[slot].arg1, tmp);
-        memory[slot].arg2 = 0;
-        return;
-    }else {
-
-        char *endptr;
-        long ival = strtol(rhs, &endptr, 10);
-        int is_int = (*endptr == '\0');
-        size_t rlen = strlen(rhs);
-        int is_str = (rlen >= 2 && rhs[0]=='\"' && rhs[rlen-1]=='\"');
-
-        if (is_int || is_str) {
-            // find next free slot in memory[5..8]
-            int slot = -1;
-            for (int i = 5; i < 8; i++) {
-                if (memory[i].identifier[0] == '\0') {
-                    slot = i;
-                    break;
-                }
-            }
-            if (slot == -1) {
-                perror("no place in memory for variables");
-                exit(EXIT_FAILURE);
-            }
-
-            // store the variable name
-            strncpy(memory[slot].identifier,
-                    lhs,
-                    sizeof memory[slot].identifier - 1);
-            memory[slot].identifier[sizeof memory[slot].identifier - 1] = '\0';
 
-            if (is_int) {
-                // integer literal
-                sprintf(memory[slot].arg1,"%d" ,ival);
-            } else {
-                // string literal: strip the quotes
-                rhs[rlen-1] = '\0';
-                strncpy(memory[slot].arg1,
-                        rhs + 1,
-                        sizeof memory[slot].arg1 - 1);
-                memory[slot].arg1[sizeof memory[slot].arg1 - 1] = '\0';
+            if (fi) {
+                if (fgets(tmp, sizeof tmp, fi)) {
+                    tmp[strcspn(tmp, "\n")] = '\0';
+                }
+                fclose(fi);
             }
         }
+        store_variable(p, &in->a, tmp);
+    } else if (in->b.text) {
+        // integer or (already unquoted) string literal
+        store_variable(p, &in->a, in->b.text);
     }
-
 }  
 
 
-void print_variable(const char* var) {
+void print_variable(FILE *out, const char* var) {
     char* endptr;
 
     // Try to convert the string to a long
@@ -385,267 +484,189 @@ void print_variable(const char* var) {
 
     // Check if the entire string was consumed by strtol
     if (*endptr == '\0') {
-        printf("Integer variable : %ld\n", int_val);
+        fprintf(out, "Integer variable : %ld\n", int_val);
     } else {
-        printf("String variable: %s\n", var);
+        fprintf(out, "String variable: %s\n", var);
     }
 }
 
 
 // execute one instruction from the process pointed at by given parameter, and return true if program finished execution
-bool execute_an_instruction( struct MemoryWord *memory){
-    int pc = atoi(memory[3].arg1);
-    int base = 8;  // because memory += 8 during parsing
-    char *line = memory[base + pc].identifier;
+static bool run_instruction(SimContext *c, PCB *p){
+    const Instruction *in = &p->code[p->pc];
+
+    delta_touch(c, p->pid);
+    metrics_run(c, p);
+    if (c->vm_on && vm_refs(c, p, in)) return false;   /* page fault: retry */
+
+    CTX_TRACE(c, TR_EXEC, p->pid, p->pc, in->op);
+
+    PROF_ENTER(c);
+    switch (in->op) {
+    case OP_EOI:
+        p->state = TERMINATED;
+        CTX_TRACE(c, TR_EXIT, p->pid, 0, 0);
+        proc_retire(c, p);
+        PROF_LEAVE(c, PROF_OP + OP_EOI);
+        return true;                             /* program finished   */
 
-    // Copy line to avoid messing with original
-    char buffer[100];
-    strcpy(buffer, line);
+    case OP_ASSIGN:
+    case OP_ASSIGN_INPUT:
+    case OP_ASSIGN_READFILE:
+        assignValue(c, in, p);
+        break;
 
-    char *cmd = strtok(buffer, " \n");
+    case OP_PRINT:
+        if (in->a.slot < 0 || !p->vars[in->a.slot].set) {
+            LOG_ERROR("pid %d: no variable named '%s'\n", p->pid, in->a.text);
+        } else if (c->out) {
+            print_variable(c->out, var_text(&p->vars[in->a.slot]));
+        }
+        break;
 
-    /* ------------- NEW: stop if we are already at EOI -------------- */
-    if (strcmp(memory[base + pc].identifier, "EOI") == 0)
-        return true;                             /* program finished   */
-    /* ----------------------------------------------------------------*/
+    case OP_WRITEFILE: {
+        // filename and content are variables if assigned, literals otherwise
+        const char *fname   = operand_text(p, &in->a);
+        const char *content = operand_text(p, &in->b);
 
-    if (strcmp(cmd, "assign") == 0) {
-        assignValue(cmd, memory);
-    }else if (strcmp(cmd, "print") == 0) {
-        char *var = strtok(NULL, " \n");
-        // lookup var and print
-        //char * rhs = strtok(cmd," \n");
-        int loc = lookupValue(memory, var);
-        if (loc < 0) {
-            fprintf(stderr, "No variable with the given name\n");
-            exit(EXIT_FAILURE);
-        }    
-
-        print_variable(memory[loc].arg1);
-        
-    }else if (strcmp(cmd, "writeFile") == 0) {
-        // Grab the two raw tokens
-        char *fileNameTok    = strtok(NULL, " \n");
-        char *fileContentTok = strtok(NULL, " \n");
-    
-        // Resolve filename: if it’s a variable, use its value; else use literal
-        int fnLoc = lookupValue(memory, fileNameTok);
-        char *fname = (fnLoc >= 0
-                       ? memory[fnLoc].arg1
-                       : fileNameTok);
-    
-        // Resolve content similarly
-        int fcLoc = lookupValue(memory, fileContentTok);
-        char *content = (fcLoc >= 0
-                         ? memory[fcLoc].arg1
-                         : fileContentTok);
-    
-        // Open and write
         FILE *fptr = fopen(fname, "w");
         if (!fptr) {
-            perror("writeFile: cannot open file");
-            exit(EXIT_FAILURE);
+            LOG_ERROR("pid %d: writeFile: cannot open '%s'\n", p->pid, fname);
+            break;
         }
         fprintf(fptr, "%s", content);
         fclose(fptr);
+        break;
     }
-    else if(strcmp(cmd, "readFile") == 0){
+
+    case OP_READFILE:
         // no reason to read file and do nothing with it so can only logically be called with assign
-        printf("no reason to read file and do nothing with it so can only logically be called with assign unless en enta bethazar");
-    }else if (strcmp(cmd, "printFromTo") == 0) {
-        // Fetch the two arguments as strings
-        char *arg1 = strtok(NULL, " \n");
-        char *arg2 = strtok(NULL, " \n");
-    
-        int x, y;
-    
-        // If arg1 is a variable in memory, use its value; else parse as literal
-        int loc1 = lookupValue(memory, arg1);
-        if (loc1 >= 0) {
-            x = atoi(memory[loc1].arg1);
-        } else {
-            x = atoi(arg1);
-        }
-    
-        // Same for arg2
-        int loc2 = lookupValue(memory, arg2);
-        if (loc2 >= 0) {
-            y = atoi(memory[loc2].arg1);
-        } else {
-            y = atoi(arg2);
-        }
-    
-        // Now print from x to y
+        if (c->out) fprintf(c->out, "no reason to read file and do nothing with it so can only logically be called with assign unless en enta bethazar");
+        break;
+
+    case OP_PRINT_FROM_TO: {
+        int x = operand_int(p, &in->a);
+        int y = operand_int(p, &in->b);
+        if (!c->out) break;
         while (x <= y) {
-            printf("%d ", x++);
+            fprintf(c->out, "%d ", x++);
         }
-        printf("\n");
+        fprintf(c->out, "\n");
+        break;
     }
-    else if (strcmp(cmd, "semWait") == 0){
-        char * resource = strtok(NULL, " \n");
-        Resources tmp; 
-        if (strcmp(resource, "userInput") == 0)
-            tmp = USER_INPUT;
-        else if (strcmp(resource, "userOutput") == 0)
-            tmp = USER_OUTPUT;
-        else if (strcmp(resource, "file") == 0)
-            tmp = FILE_ACCESS;
-        else {
-            perror("invalid resource allocation request");
-            exit(EXIT_FAILURE);
-        }
-        Resources_availability[tmp] = false;
-       
-    }else if (strcmp(cmd, "semSignal") == 0){
-        char * resource = strtok(NULL, " \n");
-        Resources tmp; 
-        if (strcmp(resource, "userInput") == 0)
-            tmp = USER_INPUT;
-        else if (strcmp(resource, "userOutput") == 0)
-            tmp = USER_OUTPUT;
-        else if (strcmp(resource, "file") == 0)
-            tmp = FILE_ACCESS;
-        else {
-            perror("invalid resource allocation request");
-            exit(EXIT_FAILURE);
-        }
-        Resources_availability[tmp] = true;
-        if (algo != MLFQ){
-            while(peek(BlockingQueues[tmp]) != NULL){
-                struct MemoryWord *tmp2 =  dequeue(BlockingQueues[tmp]);
-                enqueue(readyQueue, tmp2, atoi(tmp2[2].arg1));
+
+    case OP_SEM_WAIT:
+        c->res_free[in->res] = false;
+        delta_res(c, in->res);
+        break;
+
+    case OP_SEM_SIGNAL:
+        c->res_free[in->res] = true;
+        delta_res(c, in->res);
+        if (c->alg != MLFQ){
+            while(peek(&c->blocked[in->res]) != NULL){
+                PCB *tmp2 =  dequeue(&c->blocked[in->res]);
+                tmp2->state = READY;
+                metrics_wake(c, tmp2);
+                CTX_TRACE(c, TR_WAKE, tmp2->pid, in->res, 0);
+                enqueue(&proc_core(c, tmp2)->ready, tmp2, tmp2->priority);
             }
         }else {
-            while( peek(BlockingQueues[tmp]) != NULL){
-                struct MemoryWord *tmp2 =  dequeue(BlockingQueues[tmp]);
-                enqueue(MLFQ_queues[atoi(tmp2[2].arg1)], tmp2, atoi(tmp2[2].arg1));
+            while( peek(&c->blocked[in->res]) != NULL){
+                PCB *tmp2 =  dequeue(&c->blocked[in->res]);
+                tmp2->state = READY;
+                metrics_wake(c, tmp2);
+                CTX_TRACE(c, TR_WAKE, tmp2->pid, in->res, 0);
+                mlfq_push(proc_core(c, tmp2), tmp2, tmp2->mlfq_level, 0);
             }
         }
-    }else{
-        perror("command entered is not proper!!");
-        exit(EXIT_FAILURE);
+        break;
     }
-
-    // Handle semWait, semSignal, etc...
+    PROF_LEAVE(c, PROF_OP + in->op);
 
     // Finally increment PC
-    sprintf(memory[3].arg1, "%d", pc + 1);
+    p->pc++;
     // return true if program finished execution
-    //printf("this shit => %d\n", memory[pc+base].identifier);
-
-    if (strcmp(memory[pc+1+base].identifier,"EOI") == 0 ) return true; 
-
+    if (in[1].op == OP_EOI) {
+        p->state = TERMINATED;
+        CTX_TRACE(c, TR_EXIT, p->pid, 0, 0);
+        proc_retire(c, p);
+        return true;
+    }
     return false;
 }
 
-bool can_execute_instruction(struct MemoryWord* memory){
-    int pc = atoi(memory[3].arg1);
-    int base = 8;  // because memory += 8 during parsing
-    char *line = memory[base + pc].identifier;
+bool execute_an_instruction(SimContext *c, PCB *p){
+    PROF_ENTER(c);
+    bool finished = run_instruction(c, p);
+    PROF_LEAVE(c, PROF_EXEC);
+    return finished;
+}
 
-    // Copy line to avoid messing with original
-    char buffer[100];
-    strcpy(buffer, line);
-
-    char *cmd = strtok(buffer, " \n"); 
-    if (strcmp(cmd, "semWait") == 0 ){
-        char * resource = strtok(NULL, " \n");
-        Resources tmp; 
-        if (strcmp(resource, "userInput") == 0)
-            tmp = USER_INPUT;
-        else if (strcmp(resource, "userOutput") == 0)
-            tmp = USER_OUTPUT;
-        else if (strcmp(resource, "file") == 0)
-            tmp = FILE_ACCESS;
-        else {
-            perror("invalid resource allocation request");
-            exit(EXIT_FAILURE);
-        }
-        return Resources_availability[tmp];            
-    }
+bool can_execute_instruction(SimContext *c, PCB *p){
+    const Instruction *in = &p->code[p->pc];
+    if (in->op == OP_SEM_WAIT)
+        return c->res_free[in->res];
     return true;    
 }
 
-MemQueue*  get_blocking_queue(struct MemoryWord* memory){
-    int pc = atoi(memory[3].arg1);
-    int base = 8;  // because memory += 8 during parsing
-    char *line = memory[base + pc].identifier;
-
-    // Copy line to avoid messing with original
-    char buffer[100];
-    strcpy(buffer, line);
-
-    char *cmd = strtok(buffer, " \n"); 
-    if (strcmp(cmd, "semWait") == 0 ){
-        char * resource = strtok(NULL, " \n");
-        Resources tmp; 
-        if (strcmp(resource, "userInput") == 0)
-            tmp = USER_INPUT;
-        else if (strcmp(resource, "userOutput") == 0)
-            tmp = USER_OUTPUT;
-        else if (strcmp(resource, "file") == 0)
-            tmp = FILE_ACCESS;
-        else {
-            perror("invalid resource allocation request");
-            exit(EXIT_FAILURE);
-        }
-        return BlockingQueues[tmp];            
-    }
+MemQueue*  get_blocking_queue(SimContext *c, PCB *p){
+    const Instruction *in = &p->code[p->pc];
+    if (in->op == OP_SEM_WAIT)
+        return &c->blocked[in->res];
     return NULL;          /* <<< and add a safe default here      */
 }
-void add_program_to_memory(struct program programList[],int idx,MemQueue *queue_to_be_used){
+// words the image of plist[idx] takes: 8 header words, the text, EOI
+int image_words(SimContext *c, int idx){
+    int image = load_image(c, c->plist[idx].programName);
+    return 8 + c->images[image].ninstr + 1;
+}
+
+// loads plist[idx] and queues it; NULL (nothing changed) if memory is full
+PCB *add_program_to_memory(SimContext *c, int idx, MemQueue *queue_to_be_used){
     /* sanity checks */
-    if (!g_plist) {
-        fprintf(stderr,
-            "[ERROR] add_program_to_memory: g_plist is NULL! "
-            "Did you forget to set it in sim_init()?\n");
-    }
-    if (idx < 0 || idx >= g_plen) {
-        fprintf(stderr,
-            "[ERROR] add_program_to_memory: idx=%d out of [0..%d)\n",
-            idx, g_plen);
+    if (!c->plist) {
+        LOG_ERROR(
+            "add_program_to_memory: plist is NULL! "
+            "Did you forget to call sim_init()?\n");
     }
-
-    /* compute the base of this program’s memory block */
-    if (PCBID == 0) {
-        Program_start_locations[PCBID] = Memory_start_location;
-    } else {
-        Program_start_locations[PCBID] =
-          Memory_start_location
-          + Program_start_locations[PCBID-1][4].arg2
-          + 1;
+    if (idx < 0 || idx >= c->plen) {
+        LOG_ERROR(
+            "add_program_to_memory: idx=%d out of [0..%d)\n",
+            idx, c->plen);
     }
-    struct MemoryWord *curr_program_memory =
-      Program_start_locations[PCBID];
 
-    fprintf(stderr,
-        "[DBG+] add_program_to_memory(programList=%p, idx=%d, queue=%p)\n"
-        "      PCBID=%d, curr_prog_mem=%p\n",
-        (void*)programList,
+    LOG_DEBUG(
+        "add_program_to_memory(ctx=%d, idx=%d, queue=%p)\n"
+        "      pid=%d, free words=%ld\n",
+        c->id,
         idx,
         (void*)queue_to_be_used,
-        PCBID,
-        (void*)curr_program_memory
+        c->next_pid,
+        alloc_free_words(&c->mem)
     );
 
-    /* enqueue into the ready queue */
-    enqueue(queue_to_be_used,
-            curr_program_memory,
-            atoi(curr_program_memory[2].arg1));
+    /* decode the program once per context; processes share the code */
+    int image = load_image(c, c->plist[idx].programName);
 
-    /* actually load the instructions into memory */
-    parseProgram(programList[idx].programName,
-                 curr_program_memory);
+    int mem_lo = mem_place(c, 8 + c->images[image].ninstr + 1);
+    if (mem_lo < 0) return NULL;
 
-    /* create the PCB (this will bump PCBID internally) */
-    createPCB(curr_program_memory,
-              programList[idx].priority);
+    /* create the PCB (this will bump next_pid internally) */
+    PCB *p = createPCB(c, image, c->plist[idx].priority, mem_lo);
+    proc_admit(c, p);
+    if (c->vm_on) vm_add_process(&c->vm, p->pid, p->mem_hi - p->mem_lo + 1);
 
-    /* mark it as “arrived” so we won’t re‑enqueue it next tick */
-    programList[idx].arrivalTime = -1;
+    /* enqueue into the ready queue */
+    p->state = READY;
+    enqueue(queue_to_be_used, p, p->priority);
+    return p;
 }
 
-void FCFS_algo(struct program programList[] , int num_of_programs){
+void FCFS_algo(SimContext *c){
+    struct program *programList = c->plist;
+    int num_of_programs = c->plen;
+    MemQueue *readyQueue = &c->cores[0].ready;
     int clockcycles = 0;
     int completed = 0;
     while(completed < num_of_programs){
@@ -653,15 +674,16 @@ void FCFS_algo(struct program programList[] , int num_of_programs){
 
             // checking if a program should be added into memory
             if ( programList[i].arrivalTime != -1 && clockcycles == programList[i].arrivalTime){
-               add_program_to_memory(programList, i, readyQueue);
+               add_program_to_memory(c, i, readyQueue);
+               programList[i].arrivalTime = -1;
             }
 
         }
         //execute the process that has its turn
         if (peek(readyQueue) != NULL){
-            int pc =  atoi(peek(readyQueue)[3].arg1)+8;
-            printf("Clock %2d: Running prog %d, PC=%d, instr='%s'\n",clockcycles, atoi(peek(readyQueue)[0].arg1) ,pc,peek(readyQueue)[pc].identifier  );
-            if (execute_an_instruction(peek(readyQueue))){
+            int pc =  peek(readyQueue)->pc+8;
+            printf("Clock %2d: Running prog %d, PC=%d, instr='%s'\n",clockcycles, peek(readyQueue)->pid ,pc,instr_text(c, peek(readyQueue)) );
+            if (execute_an_instruction(c, peek(readyQueue))){
                 dequeue(readyQueue);
                 completed++;
             }
@@ -671,18 +693,22 @@ void FCFS_algo(struct program programList[] , int num_of_programs){
 }
 
 
-void RR_algo(struct program programList[] , int num_of_programs, int Quanta ){
+void RR_algo(SimContext *c, int Quanta ){
+    struct program *programList = c->plist;
+    int num_of_programs = c->plen;
+    MemQueue *readyQueue = &c->cores[0].ready;
     int clockcycles = 0;
     // check arrivals first then move just executed process to back of queue
     int current_quanta = 0;
     int completed = 0;
-    struct MemoryWord* current_process = NULL;    
+    PCB* current_process = NULL;    
 
     while(completed < num_of_programs){
         for (int i = 0; i < num_of_programs; i++){
             // checking if a program should be added into memory
             if ( programList[i].arrivalTime != -1 && clockcycles == programList[i].arrivalTime){
-               add_program_to_memory(programList, i, readyQueue);
+               add_program_to_memory(c, i, readyQueue);
+               programList[i].arrivalTime = -1;
             }
 
         }
@@ -696,16 +722,15 @@ void RR_algo(struct program programList[] , int num_of_programs, int Quanta ){
             // continuing the execution of the current process
             // check if we can execute instruction and if so then we execute
             //dumpMemory(Memory_start_location);
-            int pc =  atoi(peek(readyQueue)[3].arg1)+8;
-           // printf("trying    => Clock %2d: Running prog %d, PC=%d, instr='%s'\n",clockcycles, atoi(peek(readyQueue)[0].arg1) ,pc,peek(readyQueue)[pc].identifier );
+           // printf("trying    => Clock %2d: Running prog %d, PC=%d, instr='%s'\n",clockcycles, peek(readyQueue)->pid ,pc,peek(readyQueue)->mem[pc].identifier );
                 
-            if (can_execute_instruction(current_process)){
-                int pc =  atoi(peek(readyQueue)[3].arg1)+8;
-                printf("executing => Clock %2d: Running prog %d, PC=%d, instr='%s'\n",clockcycles, atoi(peek(readyQueue)[0].arg1) ,pc,peek(readyQueue)[pc].identifier );
+            if (can_execute_instruction(c, current_process)){
+                int pc =  peek(readyQueue)->pc+8;
+                printf("executing => Clock %2d: Running prog %d, PC=%d, instr='%s'\n",clockcycles, peek(readyQueue)->pid ,pc,instr_text(c, peek(readyQueue)) );
                 //printQueue();
                 // checking if last instruction and resetting the quanta
                 // executing the instruction, will ready the corresponding blocked processes in case of semSignal  
-                if (execute_an_instruction(current_process)){
+                if (execute_an_instruction(c, current_process)){
                     dequeue(readyQueue);
                     current_quanta = 0;
                     completed++;
@@ -713,8 +738,8 @@ void RR_algo(struct program programList[] , int num_of_programs, int Quanta ){
                 else {
                     current_quanta++;
                     if (current_quanta == Quanta){
-                        struct MemoryWord *tmp=  dequeue(readyQueue);
-                        enqueue(readyQueue, tmp,atoi(tmp[2].arg1));
+                        PCB *tmp=  dequeue(readyQueue);
+                        enqueue(readyQueue, tmp,tmp->priority);
                         current_quanta = 0;
                     }
                 }
@@ -722,8 +747,9 @@ void RR_algo(struct program programList[] , int num_of_programs, int Quanta ){
             }
             // if we cant execute an instruction it must be due to resource blocking so we must place in the appropriate blocked queue
             else{
-                struct MemoryWord *tmp=  dequeue(readyQueue);
-                enqueue(get_blocking_queue(current_process), tmp,atoi(tmp[2].arg1) );
+                PCB *tmp=  dequeue(readyQueue);
+                tmp->state = WAITING;
+                enqueue(get_blocking_queue(c, current_process), tmp,tmp->priority );
                 current_quanta = 0;
 
             }                
@@ -735,99 +761,82 @@ void RR_algo(struct program programList[] , int num_of_programs, int Quanta ){
 
 
 
-void MLFQ_algo(struct program programList[], int number_of_programs) {
-    const int num_levels = 4;
-    // initialize the 4 ready–queues
-    for (int lvl = 0; lvl < num_levels; ++lvl) {
-        initQueue(&MLFQ_queues_not_ptrs[lvl]);
-        MLFQ_queues[lvl] = &MLFQ_queues_not_ptrs[lvl];
-    }
-    // timeslice for each level = 2^(lvl+1): Q0=2, Q1=4, Q2=8, Q3=16
-    int quantum_per_level[num_levels];
-    for (int lvl = 0; lvl < num_levels; ++lvl){
-        quantum_per_level[lvl] = 1 << lvl;
-    }
+void MLFQ_algo(SimContext *c) {
+    struct program *programList = c->plist;
+    int number_of_programs = c->plen;
+    // level count and timeslices come from the context (sim_set_mlfq)
+    const int num_levels = c->mlfq_levels;
+    const int *quantum_per_level = c->mlfq_quanta;
+    Core *k = &c->cores[0];               // the old loop models one CPU
     printf("\n");
-    // per‐program MLFQ state
-    for (int p = 0; p < number_of_programs; ++p) {
-        curr_level[p]   = -1;
-        rem_quantum[p]  = 0;
-    }
 
     int completed = 0;
     int clock = 0;
-    struct MemoryWord *running = NULL;
-    int run_pid = -1;
+    PCB *running = NULL;
 
     while (completed < number_of_programs) {
         // —— first: unblock any processes just signaled ——
         for (int r = 0; r < NUM_RESOURCES; ++r) {
-            while (Resources_availability[r] && !isEmpty(BlockingQueues[r])) {
-                struct MemoryWord *mw = dequeue(BlockingQueues[r]);
-                int pid = atoi(mw->arg1);
-                int lvl = curr_level[pid];
-                enqueue(MLFQ_queues[lvl], mw, 0);
-                printf("[C=%3d] UNBLOCK → pid=%d back to Q%d\n", clock, pid, lvl);
+            while (c->res_free[r] && !isEmpty(&c->blocked[r])) {
+                PCB *mw = dequeue(&c->blocked[r]);
+                int lvl = mw->mlfq_level;
+                mw->state = READY;
+                mlfq_push(k, mw, lvl, 0);
+                printf("[C=%3d] UNBLOCK → pid=%d back to Q%d\n", clock, mw->pid, lvl);
             }
         }
         // —— arrivals ——
         for (int p = 0; p < number_of_programs; ++p) {
             if (programList[p].arrivalTime == clock) {
-                add_program_to_memory(programList, p, MLFQ_queues[0]);
-                curr_level[p]  = 0;
-                rem_quantum[p] = quantum_per_level[0];
+                PCB *np = add_program_to_memory(c, p, &k->mlfq[0]);
+                if (!np) continue;
+                mlfq_sync(k, 0);
+                np->mlfq_level  = 0;
+                np->rem_quantum = quantum_per_level[0];
                 //printf("[C=%3d] ARRIVE → pid=%d in Q0\n", clock, p);
             }
         }
         // —— preempt if a higher‐priority queue is non‐empty ——
-        int highest_ready = -1;
-        for (int lvl = 0; lvl < num_levels; ++lvl) {
-            if (!isEmpty(MLFQ_queues[lvl])) { highest_ready = lvl; break; }
-        }
-        if (running && highest_ready != -1 && highest_ready < curr_level[run_pid]) {
+        int highest_ready = mlfq_first(k);
+        if (running && highest_ready != -1 && highest_ready < running->mlfq_level) {
             // preempt current
-           // printf("[C=%3d] PREEMPT → pid=%d lvl=%d rem_q=%d\n",clock, run_pid, curr_level[run_pid], rem_quantum[run_pid]);
-            enqueue(MLFQ_queues[curr_level[run_pid]], running, 0);
+           // printf("[C=%3d] PREEMPT → pid=%d lvl=%d rem_q=%d\n",clock, running->pid, running->mlfq_level, running->rem_quantum);
+            running->state = READY;
+            mlfq_push(k, running, running->mlfq_level, 0);
             running = NULL;
         }
         // —— dispatch if CPU is free ——
         if (!running) {
-            int sel_lvl = -1;
-            for (int lvl = 0; lvl < num_levels; ++lvl) {
-                if (!isEmpty(MLFQ_queues[lvl])) { sel_lvl = lvl; break; }
-            }
+            int sel_lvl = mlfq_first(k);
             if (sel_lvl != -1) {
-                running = dequeue(MLFQ_queues[sel_lvl]);
-                run_pid = atoi(running->arg1);
+                running = mlfq_pop(k, sel_lvl);
+                running->state = RUNNING;
                 // ensure rem_quantum is set (for freshly arrived or demoted)
-                if (rem_quantum[run_pid] == 0)
-                    rem_quantum[run_pid] = quantum_per_level[sel_lvl];
-                curr_level[run_pid] = sel_lvl;
-                //printf("[C=%3d] DISPATCH → pid=%d from Q%d rem_q=%d\n",clock, run_pid, sel_lvl, rem_quantum[run_pid]);
+                if (running->rem_quantum == 0)
+                    running->rem_quantum = quantum_per_level[sel_lvl];
+                running->mlfq_level = sel_lvl;
+                //printf("[C=%3d] DISPATCH → pid=%d from Q%d rem_q=%d\n",clock, running->pid, sel_lvl, running->rem_quantum);
             }
         }
         //print all queues
       
         // —— execute one time unit ——
         if (running) {
-            int lvl = curr_level[run_pid];
-            int pc  = atoi(running[3].arg1);
-            char *instr = running[8 + pc].identifier;
-            //printf("[C=%3d] RUN      pid=%d lvl=%d pc=%d instr=\"%s\" rem_q=%d\n", clock, run_pid, lvl, pc, instr, rem_quantum[run_pid]);
-            bool finished = execute_an_instruction(running);
+            //printf("[C=%3d] RUN      pid=%d lvl=%d pc=%d instr=\"%s\" rem_q=%d\n", clock, running->pid, running->mlfq_level, running->pc, running->mem[8 + running->pc].identifier, running->rem_quantum);
+            bool finished = execute_an_instruction(c, running);
             if (finished) {
                 completed++;
-                //printf("FINISHED → pid=%d (done=%d)\n", run_pid, ++completed);
+                //printf("FINISHED → pid=%d (done=%d)\n", running->pid, ++completed);
                 running = NULL;
             } else {
-                rem_quantum[run_pid]--;
-                if (rem_quantum[run_pid] == 0) {
-                    int old_lvl = lvl;
-                    if (curr_level[run_pid] < num_levels - 1)
-                        curr_level[run_pid]++;
-                    rem_quantum[run_pid] = quantum_per_level[curr_level[run_pid]];
-                    //printf("           TIMESLICE→ pid=%d demote→Q%d rem_q=%d\n",run_pid, curr_level[run_pid], rem_quantum[run_pid]);
-                    enqueue(MLFQ_queues[curr_level[run_pid]], running, 0);
+                running->rem_quantum--;
+                if (running->rem_quantum == 0) {
+                    if (running->mlfq_level < num_levels - 1)
+                        running->mlfq_level++;
+                    running->rem_quantum = quantum_per_level[running->mlfq_level];
+                    //printf("           TIMESLICE→ pid=%d demote→Q%d rem_q=%d\n",running->pid, running->mlfq_level, running->rem_quantum);
+                    running->state = READY;
+                    mlfq_push(k, running, running->mlfq_level, 0);
                     running = NULL;
                 }
             }
@@ -835,7 +844,7 @@ void MLFQ_algo(struct program programList[], int number_of_programs) {
         clock++;
         // for (int lvl = 0; lvl < num_levels; ++lvl) {
         //     printf("Q%d: ", lvl);
-        //     printQueue(MLFQ_queues[lvl], lvl);
+        //     printQueue(&k->mlfq[lvl], lvl);
         // }
     }
     printf("[DONE] All %d progs done at clock %d\n", number_of_programs, clock);
@@ -844,32 +853,23 @@ void MLFQ_algo(struct program programList[], int number_of_programs) {
 
 
 
-void scheduler(struct program programList[] , int num_of_Programs){
-    // initialize ready queue, blocking queue, and running process
-    struct MemoryWord *runningProcessLocation = NULL;
-    
-    initQueue(&readyQueueNotPtr);
-    readyQueue = &readyQueueNotPtr;
-
-    for (size_t i = 0; i < NUM_RESOURCES; i++)
-    {
-        initQueue(&BlockingQueuesNotPtrs[i]);
-        BlockingQueues[i] = &BlockingQueuesNotPtrs[i];
-    }
-    
+void scheduler(SimContext *c, struct program programList[] , int num_of_Programs){
     //setting the scheduling algorithm
-    algo = MLFQ; 
-    int quanta = 2; 
+    SCHEDULING_ALGORITHM algo = MLFQ;
+    int quanta = 2;
+
+    // fresh queues, memory and a private copy of the program list
+    sim_init(c, programList, num_of_Programs, algo, quanta);
     switch (algo)
     {
     case FCFS:
-        FCFS_algo(programList, num_of_Programs);
+        FCFS_algo(c);
         break;
     case RR:
-        RR_algo(programList, num_of_Programs,quanta );
+        RR_algo(c, quanta );
         break;
     case MLFQ:
-        MLFQ_algo(programList, num_of_Programs);
+        MLFQ_algo(c);
         break;
     }
     
@@ -880,8 +880,7 @@ void scheduler(struct program programList[] , int num_of_Programs){
 
 
 // int main() {
-//     // Create and zero memory
-//     Memory_start_location = createMemory();
+//     SimContext *c = sim_create();
 
     
 //     /*
@@ -897,9 +896,9 @@ void scheduler(struct program programList[] , int num_of_Programs){
 //         {"Program_3.txt" , 0, 4, }
 //     };  
 
-//     scheduler(programList, 3);
+//     scheduler(c, programList, 3);
 
-//     free(Memory_start_location);
+//     sim_destroy(c);
 //     return 0;
 // }
 
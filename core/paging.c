@@ -0,0 +1,192 @@
+/*  core/paging.c  – frames, page tables, TLB and page replacement  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "paging.h"
+
+const char *repl_policy_name(ReplPolicy p)
+{
+    switch (p) {
+    case REPL_FIFO:  return "fifo";
+    case REPL_LRU:   return "lru";
+    case REPL_CLOCK: return "clock";
+    }
+    return "?";
+}
+
+static void *xcalloc(size_t n, size_t size)
+{
+    void *p = calloc(n ? n : 1, size);
+    if (!p) { perror("paging"); exit(EXIT_FAILURE); }
+    return p;
+}
+
+static void tlb_flush(PageSystem *vm)
+{
+    for (int i = 0; i < vm->tlb_size; i++) vm->tlb[i].vpage = -1;
+}
+
+void vm_init(PageSystem *vm, int frames, int page_words, int tlb_size,
+             ReplPolicy policy)
+{
+    memset(vm, 0, sizeof *vm);
+    vm->nframes    = frames;
+    vm->page_words = page_words;
+    vm->tlb_size   = tlb_size;
+    vm->policy     = policy;
+    vm->tlb_pid    = -1;
+
+    vm->frames      = xcalloc(frames, sizeof *vm->frames);
+    vm->free_frames = xcalloc(frames, sizeof *vm->free_frames);
+    for (int f = 0; f < frames; f++) {
+        vm->frames[f].pid = -1;
+        vm->free_frames[vm->nfree++] = frames - 1 - f;   /* frame 0 first */
+    }
+    vm->tlb = xcalloc(tlb_size, sizeof *vm->tlb);
+    tlb_flush(vm);
+}
+
+void vm_destroy(PageSystem *vm)
+{
+    for (int i = 0; i < vm->cap; i++) free(vm->pt[i]);
+    free(vm->pt);
+    free(vm->pt_len);
+    free(vm->per);
+    free(vm->frames);
+    free(vm->free_frames);
+    free(vm->tlb);
+    memset(vm, 0, sizeof *vm);
+}
+
+void vm_add_process(PageSystem *vm, int pid, int words)
+{
+    if (pid >= vm->cap) {
+        int cap = vm->cap ? vm->cap : 64;
+        while (cap <= pid) cap *= 2;
+        vm->pt     = realloc(vm->pt,     cap * sizeof *vm->pt);
+        vm->pt_len = realloc(vm->pt_len, cap * sizeof *vm->pt_len);
+        vm->per    = realloc(vm->per,    cap * sizeof *vm->per);
+        if (!vm->pt || !vm->pt_len || !vm->per) {
+            perror("paging");
+            exit(EXIT_FAILURE);
+        }
+        memset(vm->pt     + vm->cap, 0, (cap - vm->cap) * sizeof *vm->pt);
+        memset(vm->pt_len + vm->cap, 0, (cap - vm->cap) * sizeof *vm->pt_len);
+        memset(vm->per    + vm->cap, 0, (cap - vm->cap) * sizeof *vm->per);
+        vm->cap = cap;
+    }
+    int pages = (words + vm->page_words - 1) / vm->page_words;
+    free(vm->pt[pid]);
+    vm->pt[pid] = malloc(pages * sizeof **vm->pt);
+    if (!vm->pt[pid]) { perror("paging"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < pages; i++) vm->pt[pid][i] = -1;
+    vm->pt_len[pid] = pages;
+    memset(&vm->per[pid], 0, sizeof vm->per[pid]);
+}
+
+void vm_release(PageSystem *vm, int pid)
+{
+    if (pid >= vm->cap || !vm->pt[pid]) return;
+    for (int i = 0; i < vm->pt_len[pid]; i++) {
+        int f = vm->pt[pid][i];
+        if (f < 0) continue;
+        vm->frames[f].pid = -1;
+        vm->free_frames[vm->nfree++] = f;
+    }
+    free(vm->pt[pid]);
+    vm->pt[pid]     = NULL;
+    vm->pt_len[pid] = 0;
+    if (vm->tlb_pid == pid) {
+        tlb_flush(vm);
+        vm->tlb_pid = -1;
+    }
+}
+
+const PageCounters *vm_counters(const PageSystem *vm, int pid)
+{
+    return pid >= 0 && pid < vm->cap ? &vm->per[pid] : NULL;
+}
+
+/* frame to load into: a free one, else the policy's victim (evicted) */
+static int take_frame(PageSystem *vm)
+{
+    if (vm->nfree) return vm->free_frames[--vm->nfree];
+
+    int v = 0;
+    if (vm->policy == REPL_CLOCK) {
+        while (vm->frames[vm->hand].ref) {
+            vm->frames[vm->hand].ref = 0;
+            vm->hand = (vm->hand + 1) % vm->nframes;
+        }
+        v = vm->hand;
+        vm->hand = (vm->hand + 1) % vm->nframes;
+    } else {
+        for (int f = 1; f < vm->nframes; f++)
+            if (vm->frames[f].stamp < vm->frames[v].stamp) v = f;
+    }
+
+    Frame *fr = &vm->frames[v];
+    vm->pt[fr->pid][fr->vpage] = -1;
+    if (vm->tlb_pid == fr->pid)
+        for (int i = 0; i < vm->tlb_size; i++)
+            if (vm->tlb[i].vpage == fr->vpage) vm->tlb[i].vpage = -1;
+    vm->evictions++;
+    if (fr->dirty) vm->writebacks++;
+    return v;
+}
+
+static void tlb_insert(PageSystem *vm, int vpage, int frame)
+{
+    int v = 0;
+    for (int i = 0; i < vm->tlb_size; i++) {
+        if (vm->tlb[i].vpage < 0) { v = i; break; }
+        if (vm->tlb[i].stamp < vm->tlb[v].stamp) v = i;
+    }
+    vm->tlb[v] = (TlbEntry){ vpage, frame, vm->now };
+}
+
+bool vm_touch(PageSystem *vm, int pid, int vaddr, bool write)
+{
+    PageCounters *pc = &vm->per[pid];
+    int vpage = vaddr / vm->page_words;
+    vm->now++;
+
+    if (vm->tlb_pid != pid) {
+        if (vm->tlb_pid >= 0) vm->tlb_flushes++;
+        tlb_flush(vm);
+        vm->tlb_pid = pid;
+    }
+
+    int frame = -1;
+    for (int i = 0; i < vm->tlb_size; i++)
+        if (vm->tlb[i].vpage == vpage) {
+            frame = vm->tlb[i].frame;
+            vm->tlb[i].stamp = vm->now;
+            break;
+        }
+
+    bool fault = false;
+    if (frame >= 0) {
+        pc->tlb_hits++;
+        vm->tlb_hits++;
+    } else {
+        pc->tlb_misses++;
+        vm->tlb_misses++;
+        frame = vm->pt[pid][vpage];
+        if (frame < 0) {
+            fault = true;
+            pc->faults++;
+            vm->faults++;
+            frame = take_frame(vm);
+            vm->frames[frame] = (Frame){ pid, vpage, vm->now, 0, 0 };
+            vm->pt[pid][vpage] = frame;
+        }
+        tlb_insert(vm, vpage, frame);
+    }
+
+    Frame *fr = &vm->frames[frame];
+    if (vm->policy == REPL_LRU) fr->stamp = vm->now;
+    fr->ref = 1;
+    if (write) fr->dirty = 1;
+    return fault;
+}
@@ -0,0 +1,77 @@
+#ifndef PAGING_H
+#define PAGING_H
+/*
+ * Demand‑paged memory model: a fixed pool of frames shared by all
+ * processes (global replacement), one page table per process, and a small
+ * fully associative TLB. The TLB is not tagged, so it is flushed whenever
+ * a different process makes a reference, which is what ties TLB
+ * behaviour to the scheduler's switching rate.
+ *
+ * Virtual addresses are word offsets into a process image (0..4 PCB,
+ * 5..7 variables, 8.. code, then EOI), as the rendered layout shows.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    REPL_FIFO,                  /* oldest loaded page */
+    REPL_LRU,                   /* least recently referenced page */
+    REPL_CLOCK                  /* second chance on a reference bit */
+} ReplPolicy;
+
+typedef struct {
+    long faults;
+    long tlb_hits, tlb_misses;
+} PageCounters;
+
+typedef struct {
+    int      pid, vpage;        /* pid -1: free */
+    uint64_t stamp;             /* FIFO: load time, LRU: last reference */
+    uint8_t  ref, dirty;
+} Frame;
+
+typedef struct {
+    int      vpage, frame;      /* vpage -1: invalid */
+    uint64_t stamp;             /* last hit, for TLB replacement */
+} TlbEntry;
+
+typedef struct {
+    int          page_words, nframes, tlb_size;
+    ReplPolicy   policy;
+
+    Frame       *frames;
+    int         *free_frames, nfree;
+    int          hand;          /* CLOCK */
+
+    TlbEntry    *tlb;
+    int          tlb_pid;       /* whose translations the TLB holds */
+
+    /* per pid */
+    int        **pt;            /* vpage -> frame, -1 = not resident */
+    int         *pt_len;
+    PageCounters *per;
+    int          cap;
+
+    uint64_t     now;           /* reference counter */
+    long         faults, evictions, writebacks;
+    long         tlb_hits, tlb_misses, tlb_flushes;
+} PageSystem;
+
+void vm_init   (PageSystem *vm, int frames, int page_words, int tlb_size,
+                ReplPolicy policy);
+void vm_destroy(PageSystem *vm);
+
+/* an empty page table for a new process image of `words` words */
+void vm_add_process(PageSystem *vm, int pid, int words);
+/* frees the process's frames and page table; its counters stay */
+void vm_release    (PageSystem *vm, int pid);
+
+/* One reference to `vaddr` by pid; returns true if it page‑faulted. */
+bool vm_touch(PageSystem *vm, int pid, int vaddr, bool write);
+
+/* counters of pid, or NULL if it never had a page table */
+const PageCounters *vm_counters(const PageSystem *vm, int pid);
+
+const char *repl_policy_name(ReplPolicy p);
+
+#endif /* PAGING_H */
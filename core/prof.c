@@ -0,0 +1,69 @@
+/*  core/prof.c  – phase names and clock calibration for the profile  */
+#include <pthread.h>
+#include "prof.h"
+#include "utilities.h"
+
+_Static_assert(PROF_N == PROF_OP + OP_SEM_SIGNAL + 1,
+               "one profile slot per opcode");
+
+static const char *const names[PROF_N] = {
+    "step", "arrival", "sched", "exec", "delta", "snapshot", "publish",
+    "op eoi", "op assign", "op assign input", "op assign readFile",
+    "op print", "op writeFile", "op readFile", "op printFromTo",
+    "op semWait", "op semSignal"
+};
+
+static void measure_read_cost(void)
+{
+    enum { BATCH = 256 };
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < 32; round++) {
+        uint64_t t0 = prof_clock();
+        for (int i = 0; i < BATCH - 1; i++) (void)prof_clock();
+        uint64_t t = (prof_clock() - t0) / BATCH;
+        if (t < best) best = t;
+    }
+    prof_read_cost = best;
+}
+
+const char *prof_phase_name(int phase)
+{
+    return phase >= 0 && phase < PROF_N ? names[phase] : "?";
+}
+
+uint64_t prof_read_cost;
+
+/* the cheapest of a few batches of back‑to‑back reads; a virtualized TSC
+   can cost tens of ns a read, which would otherwise land in every phase */
+void prof_calibrate(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, measure_read_cost);
+}
+
+static double mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* the TSC rate, measured once against the monotonic clock over ~10 ms */
+double prof_ns_per_unit(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    static double rate;
+    double r;
+    __atomic_load(&rate, &r, __ATOMIC_RELAXED);
+    if (r) return r;
+    double   t0 = mono_ns();
+    uint64_t c0 = prof_clock();
+    while (mono_ns() - t0 < 1e7)
+        ;
+    r = (mono_ns() - t0) / (double)(prof_clock() - c0);
+    __atomic_store(&rate, &r, __ATOMIC_RELAXED);
+    return r;
+#else
+    return 1;
+#endif
+}
@@ -0,0 +1,106 @@
+#ifndef PROF_H
+#define PROF_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Hot‑path profile of one context: calls and time per phase of a step
+ * and per opcode handler.
+ *
+ * A PROF_ENTER/PROF_LEAVE pair counts a scope and times it with the TSC
+ * (x86) or the monotonic clock. Scopes nest: a phase's total includes
+ * the phases it encloses, its self time does not, so the self column of
+ * a dump adds up to the time spent stepping. Reading the clock costs
+ * about as much as a short phase, so only one outermost scope (a step,
+ * mostly) in PROF_SAMPLE is timed, with everything inside it; times are
+ * scaled up by calls / timed calls, and the cost of the clock reads
+ * themselves (prof_calibrate) is taken out. Scopes opened while the
+ * profile is muted (cores stepped on other host threads) are not counted.
+ * Debug builds compile the profile in; release builds (-DNDEBUG) compile
+ * it out unless built with -DSIM_PROF=1.
+ */
+#ifndef SIM_PROF
+#  ifdef NDEBUG
+#    define SIM_PROF 0
+#  else
+#    define SIM_PROF 1
+#  endif
+#endif
+
+typedef enum {
+    PROF_STEP,          /* one scheduling step, everything included */
+    PROF_ARRIVAL,       /* arrivals, timed events, admission */
+    PROF_SCHED,         /* picking, queueing and preempting (policy code) */
+    PROF_EXEC,          /* execute_an_instruction, around its handler */
+    PROF_DELTA,         /* end‑of‑step delta records */
+    PROF_SNAPSHOT,      /* fill_snapshot */
+    PROF_PUBLISH,       /* publishing for sim_latest */
+    PROF_OP,            /* + opcode: the handler of one instruction */
+    PROF_N = PROF_OP + 10                     /* Opcode has 10 values */
+} ProfPhase;
+
+#define PROF_DEPTH  8
+#define PROF_SAMPLE 16          /* power of two */
+
+typedef struct {
+    long     calls[PROF_N], timed[PROF_N];
+    uint64_t total[PROF_N], self[PROF_N];     /* clock units, timed calls */
+    uint64_t start[PROF_DEPTH], child[PROF_DEPTH];
+    int      depth;
+    unsigned outer;                           /* outermost scopes so far */
+    bool     timing;                          /* this one is sampled */
+    bool     muted;
+} Profile;
+
+static inline uint64_t prof_clock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+/* clock units one prof_clock() call costs; set by prof_calibrate() */
+extern uint64_t prof_read_cost;
+
+static inline void prof_enter(Profile *p)
+{
+    if (p->muted) return;
+    int d = p->depth++;
+    if (!d) p->timing = (p->outer++ & (PROF_SAMPLE - 1)) == 0;
+    if (!p->timing) return;
+    p->start[d] = prof_clock();
+    p->child[d] = 0;
+}
+
+static inline void prof_leave(Profile *p, int phase)
+{
+    if (p->muted) return;
+    int d = --p->depth;
+    p->calls[phase]++;
+    if (!p->timing) return;
+    uint64_t el = prof_clock() - p->start[d];
+    el = el > prof_read_cost ? el - prof_read_cost : 0;
+    p->timed[phase]++;
+    p->total[phase] += el;
+    p->self[phase]  += el > p->child[d] ? el - p->child[d] : 0;
+    if (d) p->child[d - 1] += el + 2 * prof_read_cost;  /* probes included */
+}
+
+void        prof_calibrate(void);         /* measures prof_read_cost, once */
+double      prof_ns_per_unit(void);       /* clock units to ns (calibrated once) */
+const char *prof_phase_name(int phase);
+
+#if SIM_PROF
+#  define PROF_ENTER(c)        prof_enter(&(c)->prof)
+#  define PROF_LEAVE(c, phase) prof_leave(&(c)->prof, (phase))
+#else
+#  define PROF_ENTER(c)        do { } while (0)
+#  define PROF_LEAVE(c, phase) do { } while (0)
+#endif
+
+#endif /* PROF_H */
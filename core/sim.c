@@ -1,380 +1,2205 @@
 /*  core/sim.c  – single‑step scheduler engine (FCFS / RR / MLFQ)  */
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include "sim.h" 
+#include "sim.h"
+#include "sim_internal.h"  /* SimContext layout + interpreter entry points */
 #include "utilities.h"     /* queue + enums + MemoryWord */
+#include "timing_wheel.h"  /* swap‑ins and other timed events */
+#include "mem_alloc.h"     /* simulated memory */
+#include "swap_file.h"     /* swapped‑out images */
+#include "paging.h"        /* paged mode */
+#include "work_pool.h"     /* host threads for the cores */
+#include "log.h"
 
+/* All engine state lives in a SimContext, so any number of simulations can
+   run side by side; each context has its own lock. */
 
-MemQueue  BlockingQueuesNotPtrs[NUM_RESOURCES];
-MemQueue *BlockingQueues[NUM_RESOURCES];
+static int next_ctx_id = 0;
 
-bool Resources_availability[NUM_RESOURCES] = { true, true, true };
-struct MemoryWord *Program_start_locations[MAX_PROGRAMS] = { 0 };
+/* forward decls */
+static void admit    (SimContext *c);
+static void step_fcfs(SimContext *c, Core *k);
+static void step_rr  (SimContext *c, Core *k);
+static void step_mlfq(SimContext *c, Core *k);
+static void fill_snapshot(SimContext *c, SimSnapshot*);
+static void publish(SimContext *c);
+static bool runnable(SimContext *c);
+static int  next_event_time(const SimContext *c);
+static void delta_resync(SimContext *c);
+static void delta_flush(SimContext *c);
+static void delta_retire(SimContext *c, int pid);
+static void metrics_done(SimContext *c, PCB *p);
+
+/* processes that will not run again: terminated or never admitted */
+static int done(const SimContext *c) { return c->finished + c->rejected; }
+
+/* Priorities only come from the workload (MLFQ levels enqueue at 0), so
+   the queues can use the O(1) bucket backend whenever that range is small;
+   with FCFS/RR and equal priorities it is a single FIFO. */
+static void configure_queues(SimContext *c)
+{
+    int lo = 0, hi = 0;
+    for (int i = 0; i < c->plen; i++) {
+        if (c->plist[i].priority < lo) lo = c->plist[i].priority;
+        if (c->plist[i].priority > hi) hi = c->plist[i].priority;
+    }
+    for (int k = 0; k < c->ncores; k++) configureQueue(&c->cores[k].ready, lo, hi);
+    for (int l = 0; l < c->ncores * c->mlfq_levels; l++)
+        configureQueue(&c->mlfq[l], lo, hi);
+    for (int r = 0; r < NUM_RESOURCES; r++) configureQueue(&c->blocked[r], lo, hi);
+}
+
+/* Room for n processes. The queues name processes by pid and look them
+   up in c->procs, so they (and the running pointers) follow the table
+   when it moves. */
+static void reserve_procs(SimContext *c, int n)
+{
+    if (n <= c->procs_cap) return;
+    int cap = c->procs_cap ? c->procs_cap : 64;
+    while (cap < n) cap *= 2;
+
+    uintptr_t old = (uintptr_t)c->procs;   /* only for the offsets below */
+    PCB *procs = realloc(c->procs, (size_t)cap * sizeof *procs);
+    ProcMetrics *pm = realloc(c->pm, (size_t)cap * sizeof *pm);
+    int *home = realloc(c->home, (size_t)cap * sizeof *home);
+    if (!procs || !pm || !home) {
+        perror("sim_init");
+        exit(EXIT_FAILURE);
+    }
+    memset(procs + c->procs_cap, 0, (size_t)(cap - c->procs_cap) * sizeof *procs);
+    c->procs     = procs;
+    c->pm        = pm;
+    c->home      = home;
+    c->procs_cap = cap;
+
+    for (int r = 0; r < NUM_RESOURCES; r++) c->blocked[r].procs = procs;
+    for (int l = 0; l < c->ncores * c->mlfq_levels; l++) c->mlfq[l].procs = procs;
+    for (int i = 0; i < c->ncores; i++) {
+        Core *k = &c->cores[i];
+        k->ready.procs = procs;
+        if (k->running)
+            k->running    = procs + ((uintptr_t)k->running    - old) / sizeof *procs;
+        if (k->ml_running)
+            k->ml_running = procs + ((uintptr_t)k->ml_running - old) / sizeof *procs;
+    }
+}
+
+/* ───────── MLFQ levels ───────── */
+static int default_quantum(int lvl) { return lvl < 30 ? 1 << lvl : 1 << 30; }
+
+static void free_mlfq(SimContext *c)
+{
+    for (int l = 0; l < c->ncores * c->mlfq_levels; l++) freeQueue(&c->mlfq[l]);
+    free(c->mlfq);
+    free(c->mlfq_bits);
+    free(c->mlfq_quanta);
+    c->mlfq = NULL;
+    c->mlfq_bits = NULL;
+    c->mlfq_quanta = NULL;
+    c->mlfq_levels = c->mlfq_words = 0;
+    for (int k = 0; k < c->ncores; k++) {
+        c->cores[k].mlfq = NULL;
+        c->cores[k].mlfq_bits = NULL;
+        c->cores[k].mlfq_summary = 0;
+    }
+}
+
+/* (re)build the level queues for the requested shape; queues are empty */
+static void apply_mlfq(SimContext *c)
+{
+    int n = c->want_levels;
+    if (n != c->mlfq_levels) {
+        free_mlfq(c);
+        int words = (n + 63) / 64;
+        c->mlfq        = malloc((size_t)c->ncores * n * sizeof *c->mlfq);
+        c->mlfq_bits   = calloc((size_t)c->ncores * words, sizeof *c->mlfq_bits);
+        c->mlfq_quanta = malloc(n * sizeof *c->mlfq_quanta);
+        if (!c->mlfq || !c->mlfq_bits || !c->mlfq_quanta) {
+            perror("sim_init");
+            exit(EXIT_FAILURE);
+        }
+        for (int l = 0; l < c->ncores * n; l++) initQueue(&c->mlfq[l], c->procs);
+        for (int k = 0; k < c->ncores; k++) {
+            c->cores[k].mlfq      = c->mlfq + (size_t)k * n;
+            c->cores[k].mlfq_bits = c->mlfq_bits + (size_t)k * words;
+        }
+        c->mlfq_levels = n;
+        c->mlfq_words  = words;
+    }
+    for (int l = 0; l < n; l++)
+        c->mlfq_quanta[l] = c->want_quanta ? c->want_quanta[l]
+                                           : default_quantum(l);
+}
+
+int sim_set_mlfq(SimContext *c, int levels, const int *quanta)
+{
+    if (levels < 1 || levels > SIM_MLFQ_MAX_LEVELS) return -1;
+    if (quanta)
+        for (int l = 0; l < levels; l++)
+            if (quanta[l] < 1) return -1;
+
+    int *copy = NULL;
+    if (quanta) {
+        copy = malloc(levels * sizeof *copy);
+        if (!copy) return -1;
+        memcpy(copy, quanta, levels * sizeof *copy);
+    }
+    pthread_mutex_lock(&c->mtx);
+    free(c->want_quanta);
+    c->want_levels = levels;
+    c->want_quanta = copy;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+void mlfq_sync(Core *k, int lvl)
+{
+    int w = lvl / 64;
+    if (isEmpty(&k->mlfq[lvl])) k->mlfq_bits[w] &= ~(1ull << (lvl % 64));
+    else                        k->mlfq_bits[w] |=   1ull << (lvl % 64);
+    if (k->mlfq_bits[w]) k->mlfq_summary |=   1ull << w;
+    else                 k->mlfq_summary &= ~(1ull << w);
+}
+
+void mlfq_push(Core *k, PCB *p, int lvl, int priority)
+{
+    enqueue(&k->mlfq[lvl], p, priority);
+    k->mlfq_bits[lvl / 64] |= 1ull << (lvl % 64);
+    k->mlfq_summary        |= 1ull << (lvl / 64);
+}
+
+PCB *mlfq_pop(Core *k, int lvl)
+{
+    PCB *p = dequeue(&k->mlfq[lvl]);
+    if (isEmpty(&k->mlfq[lvl])) mlfq_sync(k, lvl);
+    return p;
+}
+
+int mlfq_first(const Core *k)
+{
+    if (!k->mlfq_summary) return -1;
+    int w = __builtin_ctzll(k->mlfq_summary);
+    return w * 64 + __builtin_ctzll(k->mlfq_bits[w]);
+}
+
+/* deepest non‑empty level, -1 if all are empty */
+static int mlfq_last(const Core *k)
+{
+    if (!k->mlfq_summary) return -1;
+    int w = 63 - __builtin_clzll(k->mlfq_summary);
+    return w * 64 + 63 - __builtin_clzll(k->mlfq_bits[w]);
+}
+
+/* ───────── simulated CPUs ───────── */
+static void free_cores(SimContext *c)
+{
+    free_mlfq(c);
+    for (int k = 0; k < c->ncores; k++) freeQueue(&c->cores[k].ready);
+    free(c->cores);
+    free(c->par_local);
+    free(c->par_list);
+    free(c->ld_min);
+    free(c->ld_max);
+    c->cores     = NULL;
+    c->par_local = NULL;
+    c->par_list  = NULL;
+    c->ld_min    = c->ld_max = NULL;
+    c->ncores    = 0;
+}
+
+/* ───────── load index ─────────
+   A core's load moves by one with every operation on its own queues
+   (core_watch) and as MLFQ dispatches or lets go of a process, and
+   the index follows along one leaf‑to‑root path at a time. */
+
+/* the winner of two subtrees; a is left of b, so it takes ties */
+static int ld_pick(const SimContext *c, int a, int b, bool most)
+{
+    if (b < 0) return a;
+    int la = c->cores[a].load, lb = c->cores[b].load;
+    return (most ? la >= lb : la <= lb) ? a : b;
+}
+
+static void ld_node(SimContext *c, int j)
+{
+    c->ld_min[j] = ld_pick(c, c->ld_min[2 * j], c->ld_min[2 * j + 1], false);
+    c->ld_max[j] = ld_pick(c, c->ld_max[2 * j], c->ld_max[2 * j + 1], true);
+}
+
+/* the whole index from the loads as they stand */
+static void ld_build(SimContext *c)
+{
+    int n = c->ld_leaves;
+    c->nbusy = c->nspare = 0;
+    for (int i = 0; i < n; i++) {
+        c->ld_min[n + i] = c->ld_max[n + i] = i < c->ncores ? i : -1;
+        if (i < c->ncores) {
+            c->nbusy  += c->cores[i].load > 0;
+            c->nspare += c->cores[i].load > 1;
+        }
+    }
+    for (int j = n - 1; j > 0; j--) ld_node(c, j);
+}
+
+/* core k has d more processes to run. While the local cores step in
+   parallel only their loads move: each ends the step where it began
+   (see plan_tick), so the index stays as it was. */
+static void load_add(SimContext *c, Core *k, int d)
+{
+    int was = k->load;
+    k->load += d;
+    if (c->par_stepping) return;
+    c->nbusy  += (k->load > 0) - (was > 0);
+    c->nspare += (k->load > 1) - (was > 1);
+    for (int j = (c->ld_leaves + (int)(k - c->cores)) / 2; j > 0; j /= 2)
+        ld_node(c, j);
+}
+
+/* (re)build the cores (and so the level queues) for the requested
+   count; queues are empty */
+static void apply_cores(SimContext *c)
+{
+    if (c->want_cores == c->ncores) return;
+    free_cores(c);
+    c->cores     = calloc(c->want_cores, sizeof *c->cores);
+    c->par_local = calloc(c->want_cores, sizeof *c->par_local);
+    c->par_list  = calloc(c->want_cores, sizeof *c->par_list);
+    for (c->ld_leaves = 1; c->ld_leaves < c->want_cores; c->ld_leaves *= 2);
+    c->ld_min    = malloc(2 * (size_t)c->ld_leaves * sizeof *c->ld_min);
+    c->ld_max    = malloc(2 * (size_t)c->ld_leaves * sizeof *c->ld_max);
+    if (!c->cores || !c->par_local || !c->par_list || !c->ld_min || !c->ld_max) {
+        perror("sim_init");
+        exit(EXIT_FAILURE);
+    }
+    c->ncores = c->want_cores;
+    for (int k = 0; k < c->ncores; k++) {
+        initQueue(&c->cores[k].ready, c->procs);
+        c->cores[k].last_pid = c->cores[k].ran = c->cores[k].ran_sent = -1;
+    }
+    ld_build(c);
+}
+
+int sim_set_cores(SimContext *c, int n)
+{
+    if (n < 1 || n > SIM_MAX_CORES) return -1;
+    pthread_mutex_lock(&c->mtx);
+    c->want_cores = n;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+/* where an arrival goes; the lowest index among equals */
+static Core *least_loaded(SimContext *c)
+{
+    return &c->cores[c->ld_min[1]];
+}
+
+/* Core k has nothing to run: move one process over from the core with
+   the most waiting (the lowest index among equals). The victim keeps
+   what it runs or dispatches next, and gives up a process from the back
+   of its queue (MLFQ: of its deepest level), which would wait there
+   longest; the process keeps its level. Returns true if k got one. */
+static bool steal(SimContext *c, Core *k)
+{
+    if (!c->nspare) return false;      /* k is idle, so not the victim */
+    Core *v = &c->cores[c->ld_max[1]];
+
+    int pid;
+    if (c->alg == MLFQ) {
+        int lvl  = mlfq_last(v);
+        int keep = !v->ml_running && lvl == mlfq_first(v)
+                   ? peek_pid(&v->mlfq[lvl]) : -1;
+        pid = steal_pid(&v->mlfq[lvl], keep);
+        mlfq_sync(v, lvl);
+        mlfq_push(k, &c->procs[pid], lvl, 0);
+    } else {
+        int keep = v->running ? v->running->pid : peek_pid(&v->ready);
+        pid = steal_pid(&v->ready, keep);
+        enqueue(&k->ready, &c->procs[pid], c->procs[pid].priority);
+    }
+    int from = (int)(v - c->cores), to = (int)(k - c->cores);
+    c->home[pid] = to;
+    k->steals++;
+    CTX_TRACE(c, TR_MIGRATE, pid, from, to);
+    return true;
+}
+
+/* ───────── host threads ───────── */
+/* local cores per task; a tick with fewer than two tasks' worth steps
+   serially, as handing out the work would cost more than it saves */
+#define PAR_GRAIN 32
+
+int sim_set_threads(SimContext *c, int n)
+{
+    if (n < 0) return -1;
+    if (n == 0) n = pool_default_threads();
+    pthread_mutex_lock(&c->mtx);
+    if (n != (c->team ? pool_team_threads(c->team) : 1)) {
+        pool_team_destroy(c->team);
+        c->team = n > 1 ? pool_team_create(n) : NULL;
+    }
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+enum { PLAN_LOCAL, PLAN_ORDERED, PLAN_STEAL, PLAN_SWAP };
+
+/* how a core steps in a parallel tick (par_local): after the local
+   ones in core order, with them, or not at all */
+enum { PAR_ORDERED, PAR_LOCAL, PAR_IDLE };
+
+/* What the step of core k will do, judged from the state at the start
+   of the tick. LOCAL: it only touches k's queues and the process it
+   runs. ORDERED: it reaches further (semaphores, termination, program
+   I/O and files); *sig is the resource if it is a semSignal. STEAL: it
+   has nothing to run and looks for a process on the other cores. SWAP:
+   it starts a swap‑in, which can evict from any core. */
+static int plan_core(const SimContext *c, Core *k, int *sig)
+{
+    PCB *p;
+    *sig = -1;
+    switch (c->alg) {
+        case FCFS: p = peek(&k->ready);                               break;
+        case RR:   p = k->running ? k->running : peek(&k->ready);     break;
+        case MLFQ: {
+            int l = mlfq_first(k);
+            p = k->ml_running ? k->ml_running
+              : l >= 0        ? peek(&k->mlfq[l]) : NULL;
+            break;
+        }
+        default:   return PLAN_SWAP;
+    }
+    if (!p)          return PLAN_STEAL;
+    if (p->swap > 0) return PLAN_SWAP;
+
+    const Instruction *in = &p->code[p->pc];
+    switch (in->op) {
+        case OP_ASSIGN:
+            break;
+        case OP_PRINT:                    /* a missing variable is logged */
+            if (c->out || in->a.slot < 0 || !p->vars[in->a.slot].set)
+                return PLAN_ORDERED;
+            break;
+        case OP_READFILE:
+        case OP_PRINT_FROM_TO:
+            if (c->out) return PLAN_ORDERED;
+            break;
+        case OP_SEM_SIGNAL:
+            *sig = in->res;
+            return PLAN_ORDERED;
+        default:
+            return PLAN_ORDERED;
+    }
+    return in[1].op == OP_EOI ? PLAN_ORDERED : PLAN_LOCAL;
+}
 
+/* Plans the tick into par_list; false if it has to (or had better)
+   step serially.
 
+   A semSignal moves the processes blocked on its resource to their
+   home cores, so a core after the first signalling one that is home to
+   such a process steps in order too: in core order it would see them
+   queued.
+
+   A swap‑in can evict from any core and a steal takes from whichever
+   core has the most to spare, and runs what it got, so from the first
+   core that does either on every core steps in order; the ones before
+   it have stepped by then in core order as well. A steal fails for sure
+   if no core has a process to spare and no core before it signals (a
+   wake‑up, also of a process that blocks this tick, is the only way to
+   add one: local steps keep the counts, a steal moves one); such a core
+   is idle, holds no one up and is not stepped at all. */
+static bool plan_tick(SimContext *c)
+{
+    if (c->vm_on || c->d_max) return false;           /* shared per step */
+    if (SIM_TRACE && __atomic_load_n(&trace_on, __ATOMIC_RELAXED)) return false;
+    if (SIM_LOG_LEVEL >= LOG_LEVEL_DEBUG && log_threshold >= LOG_LEVEL_DEBUG)
+        return false;                                 /* keep the log in order */
+
+    bool spare = c->nspare > 0;
+
+    int first_sig[NUM_RESOURCES];
+    bool signalled = false;             /* a core so far does a semSignal */
+    for (int r = 0; r < NUM_RESOURCES; r++) first_sig[r] = -1;
+    int i;
+    for (i = 0; i < c->ncores; i++) {
+        int sig, plan = plan_core(c, &c->cores[i], &sig);
+        if (plan == PLAN_SWAP || (plan == PLAN_STEAL && (spare || signalled)))
+            break;
+        c->par_local[i] = plan == PLAN_LOCAL ? PAR_LOCAL
+                        : plan == PLAN_STEAL ? PAR_IDLE : PAR_ORDERED;
+        if (sig >= 0 && first_sig[sig] < 0) first_sig[sig] = i;
+        signalled |= sig >= 0;
+    }
+    for (; i < c->ncores; i++) c->par_local[i] = PAR_ORDERED;
+
+    for (int r = 0; r < NUM_RESOURCES; r++) {
+        MemQueue *bq = &c->blocked[r];
+        if (first_sig[r] < 0 || !bq->size) continue;
+        if (bq->size > c->par_pids_cap) {
+            int cap = c->par_pids_cap ? c->par_pids_cap : 64;
+            while (cap < bq->size) cap *= 2;
+            int *pids = realloc(c->par_pids, (size_t)cap * sizeof *pids);
+            if (!pids) { perror("sim_step"); exit(EXIT_FAILURE); }
+            c->par_pids     = pids;
+            c->par_pids_cap = cap;
+        }
+        int n = queuePids(bq, c->par_pids, bq->size);
+        for (int j = 0; j < n; j++) {
+            int h = c->home[c->par_pids[j]];
+            if (h > first_sig[r]) c->par_local[h] = PAR_ORDERED;
+        }
+    }
+
+    c->par_nlocal = 0;
+    for (int i = 0; i < c->ncores; i++)
+        if (c->par_local[i] == PAR_LOCAL) c->par_list[c->par_nlocal++] = i;
+    return c->par_nlocal >= 2 * PAR_GRAIN;
+}
+
+/* ───────── simulated memory ───────── */
+int sim_set_memory(SimContext *c, int words, AllocPolicy policy, bool compact)
+{
+    if (words < BUDDY_MIN_WORDS) return -1;
+    if (policy != ALLOC_FIRST_FIT && policy != ALLOC_BEST_FIT &&
+        policy != ALLOC_BUDDY) return -1;
+    pthread_mutex_lock(&c->mtx);
+    c->mem_words   = words;
+    c->mem_policy  = policy;
+    c->mem_compact = compact;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+void sim_mem_stats(SimContext *c, SimMemStats *o)
+{
+    pthread_mutex_lock(&c->mtx);
+    const MemAllocator *a = &c->mem;
+    memset(o, 0, sizeof *o);
+    o->policy         = c->mem_policy;
+    o->capacity       = a->capacity;
+    o->in_use         = a->st.in_use;
+    o->free_words     = alloc_free_words(a);
+    o->free_blocks    = alloc_free_blocks(a);
+    o->largest_free   = alloc_largest_free(a);
+    o->ext_frag       = o->free_words
+                      ? 1.0 - (double)o->largest_free / o->free_words : 0.0;
+    o->internal_waste = a->st.in_use - a->st.requested;
+    o->allocs         = a->st.allocs;
+    o->frees          = a->st.frees;
+    o->failures       = a->st.failures;
+    o->compactions    = c->compactions;
+    o->words_moved    = c->words_moved;
+    long calls        = a->st.allocs + a->st.failures;
+    o->alloc_ns_avg   = calls ? (double)a->st.alloc_ns_total / calls : 0.0;
+    o->alloc_ns_max   = a->st.alloc_ns_max;
+    o->pending        = c->pend_len;
+    o->rejected       = c->rejected;
+    o->delayed        = c->delayed;
+    o->wait_ticks_total = c->wait_total;
+    o->wait_ticks_max = c->wait_max;
+    o->swap_outs      = c->swap_outs;
+    o->swap_ins       = c->swap_ins;
+    o->swap_words_out = c->swap_words_out;
+    o->swap_words_in  = c->swap_words_in;
+    o->swap_bytes_out = c->swap.bytes_written;
+    o->swap_bytes_in  = c->swap.bytes_read;
+    o->swap_wait_ticks= c->swap_wait;
+    o->swapped        = c->swapped;
+    if (c->vm_on) {
+        const PageSystem *vm = &c->vm;
+        o->frames      = vm->nframes;
+        o->frames_free = vm->nfree;
+        o->page_faults = vm->faults;
+        o->evictions   = vm->evictions;
+        o->writebacks  = vm->writebacks;
+        o->tlb_hits    = vm->tlb_hits;
+        o->tlb_misses  = vm->tlb_misses;
+        o->tlb_flushes = vm->tlb_flushes;
+    }
+    pthread_mutex_unlock(&c->mtx);
+}
+
+int sim_set_paging(SimContext *c, int frames, int page_words,
+                   int tlb_entries, ReplPolicy policy, bool fault_stall)
+{
+    if (frames && (frames < 3 || page_words < 1 || tlb_entries < 1))
+        return -1;
+    if (policy != REPL_FIFO && policy != REPL_LRU && policy != REPL_CLOCK)
+        return -1;
+    pthread_mutex_lock(&c->mtx);
+    c->vm_frames     = frames;
+    c->vm_page_words = page_words;
+    c->vm_tlb        = tlb_entries;
+    c->vm_policy     = policy;
+    c->vm_want_stall = fault_stall;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+bool vm_refs(SimContext *c, PCB *p, const Instruction *in)
+{
+    bool writes = in->op == OP_ASSIGN || in->op == OP_ASSIGN_INPUT ||
+                  in->op == OP_ASSIGN_READFILE;
+    bool fault  = vm_touch(&c->vm, p->pid, 8 + p->pc, false);   /* code word */
+    if (in->a.slot >= 0)
+        fault |= vm_touch(&c->vm, p->pid, FIRST_VAR_SLOT + in->a.slot, writes);
+    if (in->b.slot >= 0)
+        fault |= vm_touch(&c->vm, p->pid, FIRST_VAR_SLOT + in->b.slot, false);
+    if (!fault) return false;
+
+    /* the retry goes ahead even if the pages were lost again meanwhile */
+    bool wait = c->vm_stall &&
+                !(c->vm_stall_pid == p->pid && c->vm_stall_pc == p->pc);
+    c->vm_stall_pid = wait ? p->pid : -1;
+    c->vm_stall_pc  = p->pc;
+    CTX_TRACE(c, TR_PAGE_FAULT, p->pid, p->pc, wait);
+    return wait;
+}
+
+int sim_set_swap(SimContext *c, bool enable, int latency, const char *dir)
+{
+    if (enable && latency < 1) return -1;
+    char *copy = NULL;
+    if (dir && !(copy = strdup(dir))) return -1;
+    pthread_mutex_lock(&c->mtx);
+    c->swap_want         = enable;
+    c->swap_want_latency = latency;
+    free(c->swap_dir);
+    c->swap_dir = copy;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+static int by_mem_lo(const void *x, const void *y)
+{
+    const PCB *a = *(PCB *const *)x, *b = *(PCB *const *)y;
+    return (a->mem_lo > b->mem_lo) - (a->mem_lo < b->mem_lo);
+}
+
+/* slide every live image down to address 0, in address order */
+static void compact(SimContext *c)
+{
+    PCB **live = malloc((c->act_len ? c->act_len : 1) * sizeof *live);
+    if (!live) { perror("compact"); exit(EXIT_FAILURE); }
+    int n = 0;
+    for (int i = 0; i < c->act_len; i++) {
+        PCB *p = &c->procs[c->active[i]];
+        if (p->state != TERMINATED && p->mem_lo >= 0) live[n++] = p;
+    }
+    qsort(live, n, sizeof *live, by_mem_lo);
+
+    int top = 0;
+    for (int i = 0; i < n; i++) {
+        PCB *p = live[i];
+        int words = p->mem_hi - p->mem_lo + 1;
+        if (p->mem_lo != top) {
+            c->words_moved += words;
+            p->mem_hi = top + words - 1;
+            p->mem_lo = top;
+            delta_touch(c, p->pid);
+        }
+        top += words;
+    }
+    free(live);
+    alloc_compacted(&c->mem, top);
+    c->compactions++;
+    CTX_TRACE(c, TR_COMPACT, -1, top, n);
+}
+
+/* ───────── swapping ───────── */
+static int image_size(const SimContext *c, const PCB *p)
+{
+    return 8 + c->images[p->image].ninstr + 1;
+}
+
+/* one transfer on the swap device; returns the tick it completes */
+static int swap_transfer(SimContext *c)
+{
+    int start = c->swap_busy > c->clk ? c->swap_busy : c->clk;
+    return c->swap_busy = start + c->swap_latency;
+}
+
+/* Blocked images go first, then ready ones from the lowest priority
+   (deepest MLFQ level); the youngest process breaks ties. Running
+   processes and images on their way in, or back in but not yet run
+   again, are never picked, so swap‑ins cannot evict each other forever. */
+static PCB *pick_victim(SimContext *c)
+{
+    PCB *best = NULL;
+    for (int i = 0; i < c->act_len; i++) {
+        PCB *p = &c->procs[c->active[i]];
+        if (p->swap || p->mem_lo < 0) continue;
+        if (p->state != READY && p->state != WAITING) continue;
+        if (best) {
+            int pw = p->state == WAITING, bw = best->state == WAITING;
+            if (pw != bw) { if (pw) best = p; continue; }
+            int pr = c->alg == MLFQ ? p->mlfq_level : p->priority;
+            int br = c->alg == MLFQ ? best->mlfq_level : best->priority;
+            if (pr < br) continue;
+        }
+        best = p;
+    }
+    return best;
+}
+
+static bool swap_out(SimContext *c, PCB *p)
+{
+    if (c->swap.fd < 0 && swap_open(&c->swap, c->swap_dir) != 0) {
+        LOG_ERROR("swap: cannot create swap file: %s; swapping off\n",
+                  strerror(errno));
+        c->swap_on = false;
+        return false;
+    }
+    int slot = swap_put(&c->swap, p->vars);
+    if (slot < 0) {
+        LOG_ERROR("swap: swap file cannot grow: %s; swapping off\n",
+                  strerror(errno));
+        c->swap_on = false;
+        return false;
+    }
+    int words = p->mem_hi - p->mem_lo + 1;
+    alloc_give(&c->mem, p->mem_lo, words);
+    free_vars(p);
+    p->swap   = slot + 1;
+    p->mem_lo = p->mem_hi = -1;
+    delta_touch(c, p->pid);
+
+    c->swapped++;
+    c->swap_outs++;
+    c->swap_words_out += words;
+    swap_transfer(c);
+    CTX_TRACE(c, TR_SWAP_OUT, p->pid, slot, words);
+    return true;
+}
+
+int mem_place(SimContext *c, int words)
+{
+    if (c->vm_on) return 0;          /* own address space, paged on demand */
+
+    bool can_compact = c->mem_compact && c->mem_policy != ALLOC_BUDDY;
+    int addr = alloc_take(&c->mem, words);
+    if (addr < 0 && can_compact && alloc_free_words(&c->mem) >= words) {
+        compact(c);
+        addr = alloc_take(&c->mem, words);
+    }
+    while (addr < 0 && c->swap_on) {
+        PCB *v = pick_victim(c);
+        if (!v || !swap_out(c, v)) break;
+        addr = alloc_take(&c->mem, words);
+        if (addr < 0 && can_compact && alloc_free_words(&c->mem) >= words) {
+            compact(c);
+            addr = alloc_take(&c->mem, words);
+        }
+    }
+    return addr;
+}
+
+/* give a swapped‑out process memory again and start reading it back;
+   false if there is no room yet */
+static bool swap_in_start(SimContext *c, PCB *p)
+{
+    int words = image_size(c, p);
+    int addr  = mem_place(c, words);
+    if (addr < 0) return false;
+    p->mem_lo = addr;
+    p->mem_hi = addr + words - 1;
+    p->state  = READY;
+    delta_touch(c, p->pid);
+
+    int done = swap_transfer(c);
+    c->swap_wait += done - c->clk;
+    wheel_schedule(&c->events, done, EV_SWAP_IN, p->pid);
+    CTX_TRACE(c, TR_SWAP_IN, p->pid, addr, done);
+    return true;
+}
+
+/* the image is back: FCFS kept the process at the head of its queue,
+   RR and MLFQ return it to the back of its queue on its core */
+static void swap_in_done(SimContext *c, PCB *p)
+{
+    swap_get(&c->swap, p->swap - 1, p->vars);
+    p->swap = -1;
+    c->swapped--;
+    c->swap_ins++;
+    c->swap_words_in += p->mem_hi - p->mem_lo + 1;
+
+    if (c->alg == MLFQ)     mlfq_push(proc_core(c, p), p, p->mlfq_level, 0);
+    else if (c->alg == RR)  enqueue(&proc_core(c, p)->ready, p, p->priority);
+}
+
+/* Head of q if it can run now. A swapped‑out head starts coming back;
+   with `stay` it keeps its place (FCFS) and nothing runs meanwhile,
+   otherwise it leaves q (or, with no room yet, goes to the back) and the
+   next head is tried. NULL if no head can run yet. */
+static PCB *resident_head(SimContext *c, MemQueue *q, bool stay)
+{
+    int tries = q->size;
+    PCB *p;
+    while ((p = peek(q)) && p->swap > 0) {
+        bool started = p->mem_lo >= 0 || swap_in_start(c, p);
+        if (stay) return NULL;
+        dequeue(q);
+        if (!started) {
+            enqueue(q, p, c->alg == MLFQ ? 0 : p->priority);
+            if (--tries <= 0) return NULL;
+        }
+    }
+    if (p) p->swap = 0;                  /* about to run: evictable again */
+    return p;
+}
+
+void mem_release(SimContext *c, PCB *p)
+{
+    if (c->vm_on) vm_release(&c->vm, p->pid);
+    else          alloc_give(&c->mem, p->mem_lo, p->mem_hi - p->mem_lo + 1);
+    free_vars(p);
+}
+
+/* ───────── process sets ───────── */
+void proc_admit(SimContext *c, PCB *p)
+{
+    if (c->act_len == c->act_cap) {
+        c->act_cap = c->act_cap ? 2 * c->act_cap : 64;
+        c->active  = realloc(c->active, c->act_cap * sizeof *c->active);
+        if (!c->active) { perror("proc_admit"); exit(EXIT_FAILURE); }
+    }
+    c->active[c->act_len++] = p->pid;      /* pids only grow: stays sorted */
+    c->home[p->pid] = 0;                   /* admit() picks the core */
+    c->pm[p->pid] = (ProcMetrics){ .arrive = c->clk, .first_run = -1,
+                                   .done = -1, .blocked_since = -1 };
+}
+
+/* gives the memory back; the list is filtered once half of it is dead,
+   so walking it costs O(live processes) amortized */
+void proc_retire(SimContext *c, PCB *p)
+{
+    mem_release(c, p);
+    delta_retire(c, p->pid);
+    metrics_done(c, p);
+    if (++c->act_dead * 2 <= c->act_len) return;
+
+    int n = 0;
+    for (int i = 0; i < c->act_len; i++)
+        if (c->procs[c->active[i]].state != TERMINATED)
+            c->active[n++] = c->active[i];
+    c->act_len  = n;
+    c->act_dead = 0;
+}
+
+static void pending_push(SimContext *c, int idx)
+{
+    if (c->pend_head + c->pend_len == c->pend_cap) {
+        if (c->pend_head) {
+            memmove(c->pending, c->pending + c->pend_head,
+                    c->pend_len * sizeof *c->pending);
+            memmove(c->pending_since, c->pending_since + c->pend_head,
+                    c->pend_len * sizeof *c->pending_since);
+            c->pend_head = 0;
+        } else {
+            c->pend_cap = c->pend_cap ? 2 * c->pend_cap : 16;
+            c->pending = realloc(c->pending, c->pend_cap * sizeof *c->pending);
+            c->pending_since = realloc(c->pending_since,
+                                       c->pend_cap * sizeof *c->pending_since);
+            if (!c->pending || !c->pending_since) {
+                perror("sim");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    c->pending[c->pend_head + c->pend_len]       = idx;
+    c->pending_since[c->pend_head + c->pend_len] = c->clk;
+    c->pend_len++;
+}
+
+static void pending_pop(SimContext *c)
+{
+    c->pend_head++;
+    if (!--c->pend_len) c->pend_head = 0;
+}
+
+/* ───────── PUBLIC API ───────── */
+SimContext *sim_create(void)
+{
+    SimContext *c = calloc(1, sizeof *c);
+    if (!c) {
+        LOG_ERROR("sim_create: out of memory\n");
+        return NULL;
+    }
+    c->id = __atomic_fetch_add(&next_ctx_id, 1, __ATOMIC_RELAXED);
+#if SIM_PROF
+    prof_calibrate();
+#endif
+    pthread_mutex_init(&c->mtx, NULL);
+    pthread_mutex_init(&c->pub_rd, NULL);
+    c->pub_mid   = 1;
+    c->pub_front = 2;
+    c->in  = stdin;
+    c->out = stdout;
+    wheel_init(&c->events, 0);
+    c->want_cores  = 1;
+    apply_cores(c);
+    c->want_levels = SIM_MLFQ_LEVELS;
+    c->mem_words   = SIM_MEM_WORDS;
+    c->mem_policy  = ALLOC_FIRST_FIT;
+    swap_init(&c->swap);
+    for (int r = 0; r < NUM_RESOURCES; r++) {
+        initQueue(&c->blocked[r], c->procs);
+        c->res_free[r] = true;
+    }
+    return c;
+}
+
+void sim_destroy(SimContext *c)
+{
+    if (!c) return;
+    sim_reset(c);
+    wheel_free(&c->events);
+    pool_team_destroy(c->team);
+    free_cores(c);
+    free(c->par_pids);
+    free(c->want_quanta);
+    free(c->pending);
+    free(c->pending_since);
+    swap_close(&c->swap);
+    free(c->swap_dir);
+    for (int r = 0; r < NUM_RESOURCES; r++) freeQueue(&c->blocked[r]);
+    free(c->procs);
+    free(c->pm);
+    free(c->home);
+    free(c->active);
+    free(c->arrivals);
+    for (int i = 0; i < c->nsrcs; i++) free(c->srcs[i].text);
+    free(c->srcs);
+    for (int i = 0; i < 3; i++) sim_snapshot_free(&c->pub[i]);
+    sim_delta_log_free(&c->dlog);
+    free(c->d_touch);
+    pthread_mutex_destroy(&c->pub_rd);
+    pthread_mutex_destroy(&c->mtx);
+    free(c);
+}
+
+void sim_set_io(SimContext *c, FILE *in, FILE *out)
+{
+    pthread_mutex_lock(&c->mtx);
+    c->in  = in;
+    c->out = out;
+    pthread_mutex_unlock(&c->mtx);
+}
+
+int sim_render_memory(SimContext *c, int pid, struct MemoryWord *out, int max)
+{
+    int n = -1;
+    pthread_mutex_lock(&c->mtx);
+    if (pid >= 0 && pid < c->next_pid)
+        n = render_process(c, &c->procs[pid], out, max);
+    pthread_mutex_unlock(&c->mtx);
+    return n;
+}
+
+/* drop the workload and every process; identity, lock and I/O survive */
+static void reset_locked(SimContext *c)
+{
+    for(int i = 0; i < c->act_len; i++)          /* retired: already freed */
+        free_vars(&c->procs[c->active[i]]);
+    if (c->procs) memset(c->procs, 0, c->next_pid * sizeof *c->procs);
+    c->next_pid = 0;
+    c->act_len = c->act_dead = 0;
+    memset(&c->h_turn,    0, sizeof c->h_turn);
+    memset(&c->h_resp,    0, sizeof c->h_resp);
+    memset(&c->h_ready,   0, sizeof c->h_ready);
+    memset(&c->h_blocked, 0, sizeof c->h_blocked);
+    free_images(c);
+
+    alloc_destroy(&c->mem);
+    c->pend_head = c->pend_len = 0;
+    c->pend_blocked = -1;
+    c->rejected = 0;
+    c->compactions = c->words_moved = 0;
+    c->delayed = c->wait_total = 0;
+    c->wait_max = 0;
+
+    swap_clear(&c->swap);
+    c->swap_busy = c->swapped = 0;
+    c->swap_outs = c->swap_ins = 0;
+    c->swap_words_out = c->swap_words_in = c->swap_wait = 0;
+    c->swap.bytes_written = c->swap.bytes_read = 0;
+
+    if (c->vm_on) vm_destroy(&c->vm);
+    c->vm_on = false;
+    c->vm_stall_pid = -1;
+
+    free(c->plist);
+    c->plist = NULL;
+    c->plen  = c->plist_cap = 0;
+    c->clk = c->finished = 0;
+
+    wheel_free(&c->events);
+    c->narrivals = c->arr_next = 0;
+    for(int l = 0; l < c->ncores * c->mlfq_levels; l++) clearQueue(&c->mlfq[l]);
+    if (c->mlfq_bits)
+        memset(c->mlfq_bits, 0,
+               (size_t)c->ncores * c->mlfq_words * sizeof *c->mlfq_bits);
+    for(int i = 0; i < c->ncores; i++) {
+        Core *k = &c->cores[i];
+        clearQueue(&k->ready);
+        k->mlfq_summary = 0;
+        k->cur_q = 0;
+        k->running = k->ml_running = NULL;
+        k->busy = k->switches = k->steals = 0;
+        k->last_pid = k->ran = k->ran_sent = -1;
+        k->load = 0;
+    }
+    ld_build(c);
+    c->par_ticks = 0;
+    for(int r = 0; r < NUM_RESOURCES; r++) {
+        clearQueue(&c->blocked[r]);
+        c->res_free[r] = true;
+    }
+}
+
+void sim_reset(SimContext *c)
+{
+    pthread_mutex_lock(&c->mtx);
+    reset_locked(c);
+    delta_resync(c);
+    if (c->pub_every) publish(c);
+    pthread_mutex_unlock(&c->mtx);
+}
+
+static int by_arrival(const void *x, const void *y)
+{
+    const Arrival *a = x, *b = y;
+    if (a->time != b->time) return a->time < b->time ? -1 : 1;
+    return (a->idx > b->idx) - (a->idx < b->idx);
+}
+
+void sim_init(SimContext *c, struct program list[], int n,
+              SCHEDULING_ALGORITHM alg, int quantum)
+{
+    pthread_mutex_lock(&c->mtx);
+    reset_locked(c);
+
+    LOG_DEBUG("sim_init[%d]: plist=%p, n=%d\n", c->id, (void*)list, n);
+    for(int i=0;i<n;i++){
+            LOG_DEBUG("  prog[%d]=%s @%d\n", i,
+                    list[i].programName,
+                    list[i].arrivalTime);
+    }
+
+    /* private copy: the caller's list is never modified */
+    c->plist   = malloc((n ? n : 1) * sizeof *c->plist);
+    if (!c->plist) {
+        perror("sim_init");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(c->plist, list, n * sizeof *c->plist);
+    c->plen    = n;
+    c->plist_cap = n ? n : 1;
+    c->alg     = alg;
+    c->quantum = quantum;
+
+    reserve_procs(c, n);
+    apply_cores(c);
+    apply_mlfq(c);
+    configure_queues(c);
+    alloc_init(&c->mem, c->mem_words, c->mem_policy);
+    c->vm_on        = c->vm_frames > 0;
+    if (c->vm_on)
+        vm_init(&c->vm, c->vm_frames, c->vm_page_words, c->vm_tlb, c->vm_policy);
+    c->vm_stall     = c->vm_want_stall;
+    c->swap_on      = c->swap_want && !c->vm_on;
+    c->swap_latency = c->swap_want_latency;
+
+    /* arrivals in time order (list order among equals); -1 means
+       "never". Lists that come sorted skip the sort. */
+    wheel_init(&c->events, 0);
+    if (n > c->arr_cap) {
+        free(c->arrivals);
+        c->arr_cap  = n;
+        c->arrivals = malloc((size_t)n * sizeof *c->arrivals);
+        if (!c->arrivals) {
+            perror("sim_init");
+            exit(EXIT_FAILURE);
+        }
+    }
+    bool sorted = true;
+    for(int i=0;i<n;i++)
+        if(list[i].arrivalTime >= 0) {
+            Arrival a = { list[i].arrivalTime, i };
+            if (c->narrivals && a.time < c->arrivals[c->narrivals - 1].time)
+                sorted = false;
+            c->arrivals[c->narrivals++] = a;
+        }
+    if (!sorted)
+        qsort(c->arrivals, c->narrivals, sizeof *c->arrivals, by_arrival);
+    delta_resync(c);
+    if (c->pub_every) publish(c);
+
+    pthread_mutex_unlock(&c->mtx);
+}
+
+int sim_submit(SimContext *c, const struct program *list, int n)
+{
+    if (n < 0) return -1;
+    pthread_mutex_lock(&c->mtx);
+    if (!c->plist) {
+        pthread_mutex_unlock(&c->mtx);
+        return -1;
+    }
+
+    /* the consumed front of the arrival list is dead weight */
+    if (c->arr_next > c->narrivals / 2) {
+        memmove(c->arrivals, c->arrivals + c->arr_next,
+                (size_t)(c->narrivals - c->arr_next) * sizeof *c->arrivals);
+        c->narrivals -= c->arr_next;
+        c->arr_next   = 0;
+    }
+    if (c->plen + n > c->plist_cap) {
+        while (c->plen + n > c->plist_cap) c->plist_cap *= 2;
+        c->plist = realloc(c->plist, (size_t)c->plist_cap * sizeof *c->plist);
+    }
+    if (c->narrivals + n > c->arr_cap) {
+        if (!c->arr_cap) c->arr_cap = 64;
+        while (c->narrivals + n > c->arr_cap) c->arr_cap *= 2;
+        c->arrivals = realloc(c->arrivals, (size_t)c->arr_cap * sizeof *c->arrivals);
+    }
+    if (!c->plist || !c->arrivals) {
+        perror("sim_submit");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(c->plist + c->plen, list, n * sizeof *list);
+    bool sorted = true;
+    for (int i = 0; i < n; i++)
+        if (list[i].arrivalTime >= 0) {
+            int t = list[i].arrivalTime;
+            Arrival a = { t < c->clk ? c->clk : t, c->plen + i };
+            if (c->narrivals > c->arr_next &&
+                a.time < c->arrivals[c->narrivals - 1].time)
+                sorted = false;
+            c->arrivals[c->narrivals++] = a;
+        }
+    if (!sorted)
+        qsort(c->arrivals + c->arr_next, c->narrivals - c->arr_next,
+              sizeof *c->arrivals, by_arrival);
+    c->plen += n;
+    reserve_procs(c, c->plen);
+
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+/* ───────── programs defined in memory ───────── */
+const char *program_source(const SimContext *c, const char *name)
+{
+    for (int i = 0; i < c->nsrcs; i++)
+        if (strcmp(c->srcs[i].name, name) == 0)
+            return c->srcs[i].text;
+    return NULL;
+}
+
+int sim_define_program(SimContext *c, const char *name, const char *text)
+{
+    if (!name || !text || !*text || strlen(name) >= sizeof c->srcs->name)
+        return -1;
+    char *copy = strdup(text);
+    if (!copy) { perror("sim_define_program"); exit(EXIT_FAILURE); }
+
+    pthread_mutex_lock(&c->mtx);
+    int i = 0;
+    while (i < c->nsrcs && strcmp(c->srcs[i].name, name) != 0) i++;
+    if (i == c->nsrcs) {
+        if (c->nsrcs == c->srcs_cap) {
+            c->srcs_cap = c->srcs_cap ? 2 * c->srcs_cap : 16;
+            c->srcs = realloc(c->srcs, c->srcs_cap * sizeof *c->srcs);
+            if (!c->srcs) { perror("sim_define_program"); exit(EXIT_FAILURE); }
+        }
+        snprintf(c->srcs[i].name, sizeof c->srcs[i].name, "%s", name);
+        c->srcs[i].text = NULL;
+        c->nsrcs++;
+    }
+    free(c->srcs[i].text);
+    c->srcs[i].text = copy;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+/* one tick of core k */
+static void step_core(SimContext *c, Core *k)
+{
+    k->ran = -1;
+    switch (c->alg) {
+        case FCFS:
+            LOG_DEBUG("Executing FCFS step on core %d\n", (int)(k - c->cores));
+            step_fcfs(c, k);
+            break;
+        case RR:
+            LOG_DEBUG("Executing Round-Robin step on core %d\n", (int)(k - c->cores));
+            step_rr(c, k);
+            break;
+        case MLFQ:
+            LOG_DEBUG("Executing MLFQ step on core %d\n", (int)(k - c->cores));
+            step_mlfq(c, k);
+            break;
+    }
+}
+
+/* one task of a parallel tick: PAR_GRAIN local cores */
+static void step_local(void *arg, int task, int worker)
+{
+    (void)worker;
+    SimContext *c = arg;
+    int end = (task + 1) * PAR_GRAIN;
+    if (end > c->par_nlocal) end = c->par_nlocal;
+    for (int i = task * PAR_GRAIN; i < end; i++)
+        step_core(c, &c->cores[c->par_list[i]]);
+}
+
+/* One tick on every core, with the result of stepping them in core
+   order. With host threads the local cores of the plan go first, in
+   parallel; nothing they touch is read or written by another core's
+   step, so the others can follow in core order as if they had run in
+   between. The idle ones would do nothing and are skipped. */
+static void step_cores(SimContext *c)
+{
+    if (c->team && plan_tick(c)) {
+#if SIM_PROF
+        c->prof.muted = true;
+#endif
+        c->par_stepping = true;
+        pool_team_run(c->team, (c->par_nlocal + PAR_GRAIN - 1) / PAR_GRAIN,
+                      step_local, c);
+        c->par_stepping = false;
+#if SIM_PROF
+        c->prof.muted = false;
+#endif
+        for (int i = 0; i < c->ncores; i++) {
+            if (c->par_local[i] == PAR_ORDERED)
+                step_core(c, &c->cores[i]);
+            else if (c->par_local[i] == PAR_IDLE)
+                c->cores[i].ran = -1;           /* its steal would fail */
+        }
+        c->par_ticks++;
+        return;
+    }
+    for (int i = 0; i < c->ncores; i++)
+        step_core(c, &c->cores[i]);
+}
 
-#define MEM_POOL_WORDS 256
+/* one scheduling step; caller holds c->mtx. Returns 1 while processes remain */
+static int step_locked(SimContext *c)
+{
+    if (done(c) == c->plen) {
+        LOG_DEBUG("All processes finished\n");
+        return 0;
+    }
 
-static struct MemoryWord _sim_memory_pool[MEM_POOL_WORDS];
-struct MemoryWord *Memory_start_location = NULL;
+    // Debug: Print ready queue state
+    LOG_DEBUG(
+        "Before switch: ready.kind=%d, size=%d\n",
+        (int)c->cores[0].ready.kind, c->cores[0].ready.size);
 
+    PROF_ENTER(c);
+    /* nothing can run until the next event: jump the clock straight to it */
+    if (!runnable(c)) {
+        int next = next_event_time(c);
+        if (next > c->clk) {
+            LOG_DEBUG("Idle: skipping clock %d -> %d\n", c->clk, next);
+            CTX_TRACE(c, TR_IDLE_SKIP, -1, next, 0);
+            c->clk = next;
+        }
+    }
 
-#include "program.h"
-#define MAX_PROGRAMS 100
-/* ───────── GLOBAL ENGINE STATE ───────── */
-static struct program *plist = NULL;
-static int   plen            = 0;
-static SCHEDULING_ALGORITHM g_alg = FCFS;
-static int   g_quantum       = 2;
+    // Admit what arrived, then one tick on every core, in core order
+    PROF_ENTER(c);
+    admit(c);
+    if (c->alg != FCFS && c->alg != RR && c->alg != MLFQ) {
+        LOG_ERROR("Unknown scheduling algorithm %d\n", c->alg);
+        PROF_LEAVE(c, PROF_SCHED);
+        PROF_LEAVE(c, PROF_STEP);
+        return 0; // Exit if the algorithm is invalid
+    }
+    step_cores(c);
+    PROF_LEAVE(c, PROF_SCHED);
 
-static int   clk             = 0;
-static int   finished        = 0;
+    // Increment clock
+    c->clk++;
+    LOG_DEBUG("Clock incremented to %d\n", c->clk);
+    PROF_ENTER(c);
+    delta_flush(c);
+    PROF_LEAVE(c, PROF_DELTA);
+    PROF_LEAVE(c, PROF_STEP);
 
-static pthread_mutex_t sim_mtx = PTHREAD_MUTEX_INITIALIZER;
+    // Determine if there are still processes alive
+    return done(c) < c->plen;
+}
 
-/* queues for resources come from your old globals */
-extern MemQueue BlockingQueuesNotPtrs[NUM_RESOURCES];
-extern MemQueue *BlockingQueues[NUM_RESOURCES];
+int sim_step(SimContext *c, SimSnapshot *out)
+{
+    pthread_mutex_lock(&c->mtx);
 
-extern struct MemoryWord *Program_start_locations[MAX_PROGRAMS];
-extern bool Resources_availability[NUM_RESOURCES];
+    // Debug: Dump pointers and counters
+    LOG_DEBUG(
+        "sim_step[%d]: plist=%p, plen=%d, clk=%d, finished=%d, out=%p\n",
+        c->id, (void*)c->plist, c->plen, c->clk, c->finished, (void*)out);
 
-/* helpers already written in your original code */
-extern void add_program_to_memory(struct program[],int,MemQueue*);
-extern bool execute_an_instruction(struct MemoryWord*);
-extern bool can_execute_instruction(struct MemoryWord*);
-extern MemQueue*  get_blocking_queue(struct MemoryWord*);
+    if (!c->plist) {
+        LOG_ERROR("sim_step called before sim_init—plist is NULL!\n");
+        pthread_mutex_unlock(&c->mtx);
+        return 0; // Return immediately if plist is not initialized
+    }
 
-/* ─── internal scheduler state ─── */
-static struct {
-    /* common */
-    MemQueue ready;
+    int alive = step_locked(c);
+    if (c->pub_every && (++c->pub_steps >= c->pub_every || !alive))
+        publish(c);
 
-    /* RR */
-    int cur_q;
-    struct MemoryWord *running;
+    if (out) {
+        LOG_DEBUG("Filling snapshot at out=%p\n", (void*)out);
+        fill_snapshot(c, out);
+    }
 
-    /* MLFQ */
-    MemQueue q[4];
-    int      cur_level[MAX_PROGRAMS];
-    int      rem_q   [MAX_PROGRAMS];
-    struct MemoryWord *ml_running;
-    int      ml_pid;
-} S;
+    LOG_DEBUG("sim_step returning alive=%d\n", alive);
 
-/* forward decls */
-static void step_fcfs(void);
-static void step_rr  (void);
-static void step_mlfq(void);
-static void fill_snapshot(SimSnapshot*);
+    pthread_mutex_unlock(&c->mtx);
+    return alive;
+}
 
-/* ───────── PUBLIC API ───────── */
-void sim_reset(void)
+/* ─────── bulk stepping: one lock, no snapshots unless sampled ─────── */
+static void fill_run_stats(SimContext *c, SimRunStats *st, long steps, int clk0, int alive)
 {
-    pthread_mutex_lock(&sim_mtx);
-    memset(&S,0,sizeof S);
-    clk = finished = 0;
-    /* clear all program‐memory pointers */
-    for(int i = 0; i < MAX_PROGRAMS; i++)
-        Program_start_locations[i] = NULL;
-    pthread_mutex_unlock(&sim_mtx);
+    st->steps      = steps;
+    st->ticks      = c->clk - clk0;
+    st->clock      = c->clk;
+    st->finished   = c->finished;
+    st->procs_total= c->plen;
+    st->alive      = alive;
 }
 
-void sim_init(struct program list[], int n,
-              SCHEDULING_ALGORITHM alg, int quantum)
-{    
-    sim_reset();
+static int run_locked(SimContext *c, long max_steps, SimStopFn stop, void *arg,
+                      SimSampler *sample, SimRunStats *out)
+{
+    SimRunStats st;
+    int  clk0  = c->clk;
+    long steps = 0;
+    int  alive = c->plist && done(c) < c->plen;
 
+    if (sample) sample->len = 0;
 
-    pthread_mutex_lock(&sim_mtx);
-    fprintf(stderr, "[DEBUG] sim_init: plist=%p, n=%d\n", (void*)list, n);
-    for(int i=0;i<n;i++){
-            fprintf(stderr, "  prog[%d]=%s @%d\n", i,
-                    list[i].programName,
-                    list[i].arrivalTime);
-    }
+    while (alive && (max_steps < 0 || steps < max_steps)) {
+        alive = step_locked(c);
+        steps++;
+        if (c->pub_every && (++c->pub_steps >= c->pub_every || !alive))
+            publish(c);
+
+        if (sample && sample->every > 0 && steps % sample->every == 0
+                   && sample->len < sample->cap)
+            fill_snapshot(c, &sample->buf[sample->len++]);
 
-    Memory_start_location = _sim_memory_pool;
-    fprintf(stderr,
-        "[DEBUG] sim_init: Memory_start_location=%p (pool at %p..%p)\n",
-        (void*)Memory_start_location,
-        (void*)_sim_memory_pool,
-        (void*)(&_sim_memory_pool[MEM_POOL_WORDS-1])
-    );
-
-    plist     = list;
-    plen      = n;
-    g_alg     = alg;
-    g_quantum = quantum;
-
-
-    initQueue(&S.ready);
-    
-    extern struct program *g_plist;
-    extern int            g_plen;
-    g_plist = plist;
-    g_plen  = plen;
-    if(alg == MLFQ){
-        for(int i=0;i<4;i++) initQueue(&S.q[i]);
-        for(int p=0;p<MAX_PROGRAMS;p++){
-            S.cur_level[p]=0;
-            S.rem_q[p]   =0;
+        if (stop) {
+            fill_run_stats(c, &st, steps, clk0, alive);
+            if (stop(&st, arg)) break;
         }
     }
-    /* BlockingQueuesNotPtrs already initialised in old main */
-    /* initialize blocking queues */
-    for(int r = 0; r < NUM_RESOURCES; r++) {
-        initQueue(&BlockingQueuesNotPtrs[r]);
-        BlockingQueues[r] = &BlockingQueuesNotPtrs[r];
 
-        // <<< DROP‑IN DEBUG: verify pointer + initial size
-        fprintf(stderr,
-            "[DEBUG] sim_init: BlockingQueues[%d] ➞ %p (size=%d)\n",
-            r,
-            (void*)BlockingQueues[r],
-            BlockingQueues[r]->size
-        );
-    }
+    if (c->pub_steps) publish(c);           /* readers see where it stopped */
+    if (out) fill_run_stats(c, out, steps, clk0, alive);
+    return alive;
+}
 
-    printf("[DEBUG] sim_init: S.ready ➞ %p  size=%d\n",(void*)&S.ready, S.ready.size);
+int sim_step_n(SimContext *c, long n, SimSampler *sample, SimRunStats *out)
+{
+    pthread_mutex_lock(&c->mtx);
+    int alive = run_locked(c, n, NULL, NULL, sample, out);
+    pthread_mutex_unlock(&c->mtx);
+    return alive;
+}
 
-    pthread_mutex_unlock(&sim_mtx);
+int sim_run_until(SimContext *c, SimStopFn stop, void *arg,
+                  SimSampler *sample, SimRunStats *out)
+{
+    pthread_mutex_lock(&c->mtx);
+    int alive = run_locked(c, -1, stop, arg, sample, out);
+    pthread_mutex_unlock(&c->mtx);
+    return alive;
 }
 
-int sim_step(SimSnapshot *out)
+int sim_run(SimContext *c, SimSampler *sample, SimRunStats *out)
 {
-    pthread_mutex_lock(&sim_mtx);
+    return sim_run_until(c, NULL, NULL, sample, out);
+}
 
-    // Debug: Dump global pointers and counters
-    fprintf(stderr,
-        "[DEBUG] sim_step: plist=%p, plen=%d, clk=%d, finished=%d, out=%p\n",
-        (void*)plist, plen, clk, finished, (void*)out);
+/* ─────── timed events ─────── */
 
-    if (!plist) {
-        fprintf(stderr, "[ERROR] sim_step called before sim_init—plist is NULL!\n");
-        pthread_mutex_unlock(&sim_mtx);
-        return 0; // Return immediately if plist is not initialized
+/* clock of the next arrival or wheel event, -1 if none is left */
+static int next_event_time(const SimContext *c)
+{
+    int t = wheel_next_time(&c->events);
+    if (c->arr_next < c->narrivals) {
+        int a = c->arrivals[c->arr_next].time;
+        if (t < 0 || a < t) t = a;
     }
+    return t;
+}
 
-    if (finished == plen) {
-        fprintf(stderr, "[DEBUG] All processes finished; calling fill_snapshot for final state\n");
-        fill_snapshot(out);
-        pthread_mutex_unlock(&sim_mtx);
-        return 0;
-    }
+/* Handles the arrivals and events due at clk, then loads the next program that has
+   arrived into q; NULL once none are left or the oldest waiting one
+   still does not fit. Arrivals are admitted strictly in order, so a
+   large image is not starved. */
+static PCB *admit_next(SimContext *c, MemQueue *q)
+{
+    while (c->arr_next < c->narrivals &&
+           c->arrivals[c->arr_next].time <= c->clk)
+        pending_push(c, c->arrivals[c->arr_next++].idx);
 
-    // Debug: Print ready queue state
-    fprintf(stderr,
-        "[DEBUG] Before switch: ready.items=%p, size=%d\n",
-        (void*)S.ready.items, S.ready.size);
+    WheelEvent ev;
+    while (wheel_pop(&c->events, c->clk, &ev))
+        switch (ev.kind) {
+        case EV_SWAP_IN: swap_in_done(c, &c->procs[ev.arg]);    break;
+        }
 
-    // Execute one step based on the scheduling algorithm
-    switch (g_alg) {
-        case FCFS:
-            fprintf(stderr, "[DEBUG] Executing FCFS step\n");
-            step_fcfs();
-            break;
-        case RR:
-            fprintf(stderr, "[DEBUG] Executing Round-Robin step\n");
-            step_rr();
-            break;
-        case MLFQ:
-            fprintf(stderr, "[DEBUG] Executing MLFQ step\n");
-            step_mlfq();
-            break;
-        default:
-            fprintf(stderr, "[ERROR] Unknown scheduling algorithm %d\n", g_alg);
-            pthread_mutex_unlock(&sim_mtx);
-            return 0; // Exit if the algorithm is invalid
+    while (c->pend_len) {
+        /* nothing was freed since the head last failed: still no room
+           (with swapping on, a victim may have appeared instead) */
+        if (!c->swap_on && c->pend_blocked == c->mem.st.frees) return NULL;
+
+        int idx   = c->pending[c->pend_head];
+        int words = image_words(c, idx);
+        if (!c->vm_on && alloc_block_words(&c->mem, words) > c->mem.capacity) {
+            LOG_ERROR("%s needs %d words, memory has %d; dropped\n",
+                      c->plist[idx].programName, words, c->mem.capacity);
+            c->rejected++;
+            pending_pop(c);
+            continue;
+        }
+        PCB *p = add_program_to_memory(c, idx, q);
+        if (!p) {
+            c->pend_blocked = c->mem.st.frees;
+            return NULL;
+        }
+        int waited = c->clk - c->pending_since[c->pend_head];
+        if (waited > 0) {
+            c->delayed++;
+            c->wait_total += waited;
+            if (waited > c->wait_max) c->wait_max = waited;
+        }
+        c->pm[p->pid].arrive = c->pending_since[c->pend_head];
+        c->pend_blocked = -1;
+        pending_pop(c);
+        CTX_TRACE(c, TR_ARRIVE, p->pid, p->mem_lo, waited);
+        return p;
     }
+    return NULL;
+}
 
-    // Increment clock and fill snapshot
-    clk++;
-    fprintf(stderr, "[DEBUG] Clock incremented to %d\n", clk);
+static PCB *next_arrival(SimContext *c, MemQueue *q)
+{
+    PROF_ENTER(c);
+    PCB *p = admit_next(c, q);
+    PROF_LEAVE(c, PROF_ARRIVAL);
+    return p;
+}
 
-    if (out) {
-        fprintf(stderr, "[DEBUG] Filling snapshot at out=%p\n", (void*)out);
-        fill_snapshot(out);
-    } else {
-        fprintf(stderr, "[ERROR] Output snapshot pointer is NULL!\n");
+/* RR and MLFQ cores run what they have; an FCFS head being swapped in
+   holds its core idle */
+static bool runnable(SimContext *c)
+{
+    if (c->alg != FCFS || !c->nbusy) return c->nbusy > 0;
+    for (int i = 0; i < c->ncores; i++) {
+        const PCB *h = peek(&c->cores[i].ready);
+        if (h && !(h->swap > 0 && h->mem_lo >= 0)) return true;
     }
+    return false;
+}
 
-    // Determine if there are still processes alive
-    int alive = (finished < plen);
-    fprintf(stderr, "[DEBUG] sim_step returning alive=%d\n", alive);
-
-    pthread_mutex_unlock(&sim_mtx);
-    return alive;
+/* ─────── arrivals: each to the least loaded core ─────── */
+static void admit(SimContext *c)
+{
+    for (;;) {
+        Core *k = least_loaded(c);
+        PCB *np = next_arrival(c, c->alg == MLFQ ? &k->mlfq[0] : &k->ready);
+        if (!np) break;
+        c->home[np->pid] = (int)(k - c->cores);
+        LOG_DEBUG("admit: queued pid=%d on core %d, mem_lo=%d\n",
+                  np->pid, c->home[np->pid], np->mem_lo);
+        if (c->alg == MLFQ) {
+            np->mlfq_level =0;
+            np->rem_quantum=c->mlfq_quanta[0];
+            mlfq_sync(k, 0);
+        }
+    }
 }
 
 /* ─────── FCFS one‑tick ─────── */
-static void step_fcfs(void)
-{
-    for(int i=0;i<plen;i++)
-        if(plist[i].arrivalTime!=-1 && clk==plist[i].arrivalTime){
-            add_program_to_memory(plist,i,&S.ready);
-            fprintf(stderr,"[DBG] step_fcfs: queued pid=%d, Program_start_locations[%d]=%p\n",i, i, (void*)Program_start_locations[i]);
-        }   
-    if(!isEmpty(&S.ready)){
-        struct MemoryWord *p = peek(&S.ready);        
-        fprintf(stderr,"[DBG] step_fcfs: about to exec pid=%s ",p->arg1);
-        if(execute_an_instruction(p)){
-            fprintf(stderr,"[DBG] step_fcfs: pid %s just terminated\n", p->arg1);
-            dequeue(&S.ready);
-            finished++;
+static void step_fcfs(SimContext *c, Core *k)
+{
+    if(isEmpty(&k->ready)) steal(c, k);
+    if(!isEmpty(&k->ready)){
+        PCB *p = resident_head(c, &k->ready, true);
+        if(!p) return;
+        LOG_DEBUG("step_fcfs: about to exec pid=%d\n",p->pid);
+        if(p->state != RUNNING){
+            p->state = RUNNING;
+            CTX_TRACE(c, TR_DISPATCH, p->pid, 0, (int)(k - c->cores));
+        }
+        if(execute_an_instruction(c, p)){
+            LOG_DEBUG("step_fcfs: pid %d just terminated\n", p->pid);
+            remove_pid(&k->ready, p->pid);   /* a wake‑up may have passed it */
+            c->finished++;
         }
     }
 }
 
 /* ─────── RR one‑tick ─────── */
-static void step_rr(void)
+/* The running process stays queued while it runs. It is normally the
+   head; a higher‑priority arrival or wake‑up can get ahead of it, which
+   takes effect when its quantum ends. */
+static void step_rr(SimContext *c, Core *k)
 {
-    for(int i=0;i<plen;i++)
-        if(plist[i].arrivalTime!=-1 && clk==plist[i].arrivalTime)
-            add_program_to_memory(plist,i,&S.ready);
+    if(!k->running && isEmpty(&k->ready)) steal(c, k);
 
-    if(!S.running && !isEmpty(&S.ready))
-        S.running = peek(&S.ready);
+    if(!k->running && !isEmpty(&k->ready)){
+        k->running = resident_head(c, &k->ready, false);
+        if(k->running)
+            CTX_TRACE(c, TR_DISPATCH, k->running->pid, 0, (int)(k - c->cores));
+    }
 
-    if(!S.running) return;
+    if(!k->running) return;
+    k->running->state = RUNNING;
 
-    if(can_execute_instruction(S.running)){
-        if(execute_an_instruction(S.running)){
-            dequeue(&S.ready);
-            finished++;
-            S.running=NULL; S.cur_q=0;
+    if(can_execute_instruction(c, k->running)){
+        if(execute_an_instruction(c, k->running)){
+            remove_pid(&k->ready, k->running->pid);
+            c->finished++;
+            k->running=NULL; k->cur_q=0;
             return;
         }
-        S.cur_q++;
-        if(S.cur_q==g_quantum){
-            struct MemoryWord *tmp = dequeue(&S.ready);
-            enqueue(&S.ready,tmp,atoi(tmp[2].arg1));
-            S.cur_q=0; S.running=NULL;
+        k->cur_q++;
+        if(k->cur_q==c->quantum){
+            PCB *tmp = k->running;
+            remove_pid(&k->ready, tmp->pid);
+            tmp->state = READY;
+            CTX_TRACE(c, TR_PREEMPT, tmp->pid, 0, 0);
+            enqueue(&k->ready,tmp,tmp->priority);
+            k->cur_q=0; k->running=NULL;
         }
     }else{
-        struct MemoryWord *tmp = dequeue(&S.ready);
-        enqueue(get_blocking_queue(tmp),tmp,atoi(tmp[2].arg1));
-        S.cur_q=0; S.running=NULL;
+        PCB *tmp = k->running;
+        remove_pid(&k->ready, tmp->pid);
+        tmp->state = WAITING;
+        metrics_block(c, tmp);
+        CTX_TRACE(c, TR_BLOCK, tmp->pid, tmp->code[tmp->pc].res, 0);
+        enqueue(get_blocking_queue(c, tmp),tmp,tmp->priority);
+        k->cur_q=0; k->running=NULL;
     }
 }
 
-/* ─────── MLFQ helpers ─────── */
-static inline int level_quant(int lvl){ return 1<<lvl; }
-
 /* ─────── MLFQ one‑tick ─────── */
-static void step_mlfq(void)
+static void step_mlfq(SimContext *c, Core *k)
 {
-    const int LVL = 4;
-
-    for(int i=0;i<plen;i++)
-        if(plist[i].arrivalTime!=-1 && clk==plist[i].arrivalTime){
-            add_program_to_memory(plist,i,&S.q[0]);
-            S.cur_level[i]=0;
-            S.rem_q[i]=level_quant(0);
-        }
+    const int LVL = c->mlfq_levels;
 
     /* simple: no explicit unblocking logic here, semSignal already moves */
 
-    if(!S.ml_running){
-        for(int l=0;l<LVL;l++)
-            if(!isEmpty(&S.q[l])){
-                S.ml_running = dequeue(&S.q[l]);
-                S.ml_pid     = atoi(S.ml_running->arg1);
-                if(S.rem_q[S.ml_pid]==0)
-                    S.rem_q[S.ml_pid]=level_quant(l);
-                S.cur_level[S.ml_pid]=l;
-                break;
-            }
+    if(!k->ml_running && !k->mlfq_summary) steal(c, k);
+
+    int l;
+    while(!k->ml_running && (l = mlfq_first(k)) >= 0){
+        PCB *h = resident_head(c, &k->mlfq[l], false);
+        mlfq_sync(k, l);
+        if(!h){
+            if(!isEmpty(&k->mlfq[l])) break;     /* head waits for memory */
+            continue;                            /* level drained by swap‑ins */
+        }
+        PCB *p = k->ml_running = mlfq_pop(k, l);
+        load_add(c, k, 1);
+        if(p->rem_quantum==0)
+            p->rem_quantum=c->mlfq_quanta[l];
+        p->mlfq_level=l;
+        p->state=RUNNING;
+        CTX_TRACE(c, TR_DISPATCH, p->pid, l, (int)(k - c->cores));
     }
-    if(!S.ml_running) return;
+    if(!k->ml_running) return;
 
-    if(execute_an_instruction(S.ml_running)){
-        finished++;
-        S.ml_running=NULL;
+    if(execute_an_instruction(c, k->ml_running)){
+        c->finished++;
+        k->ml_running=NULL;
+        load_add(c, k, -1);
         return;
     }
 
-    S.rem_q[S.ml_pid]--;
-    if(S.rem_q[S.ml_pid]==0){
-        int old = S.cur_level[S.ml_pid];
+    PCB *p = k->ml_running;
+    p->rem_quantum--;
+    if(p->rem_quantum==0){
+        int old = p->mlfq_level;
         int nxt = (old<LVL-1)?old+1:old;
-        S.cur_level[S.ml_pid]=nxt;
-        S.rem_q[S.ml_pid]=level_quant(nxt);
-        enqueue(&S.q[nxt],S.ml_running,0);
-        S.ml_running=NULL;
+        p->mlfq_level =nxt;
+        p->rem_quantum=c->mlfq_quanta[nxt];
+        p->state=READY;
+        CTX_TRACE(c, TR_PREEMPT, p->pid, nxt, 0);
+        mlfq_push(k, p, nxt, 0);
+        k->ml_running=NULL;
+        load_add(c, k, -1);
+    }
+}
+
+/* ─────── metrics: a few counter updates per tick ─────── */
+void metrics_run(SimContext *c, PCB *p)
+{
+    ProcMetrics *m = &c->pm[p->pid];
+    Core *k = proc_core(c, p);
+    if (m->first_run < 0) m->first_run = c->clk;
+    m->cpu++;
+    k->busy++;
+    k->ran = p->pid;
+    if (p->pid != k->last_pid) {
+        if (k->last_pid >= 0) k->switches++;
+        k->last_pid = p->pid;
     }
 }
 
-/* ─────── snapshot − uses queue->items array ─────── */
-static void fill_snapshot(SimSnapshot *o)
+/* the blocking tick counts as blocked, and so does the tick of the
+   wake‑up: the process can run on the next one at the earliest */
+void metrics_block(SimContext *c, PCB *p)
 {
-    fprintf(stderr,
-        "[DEBUG] fill_snapshot: out=%p, clk=%d, finished=%d, plen=%d\n",
-        (void*)o, clk, finished, plen);
+    c->pm[p->pid].blocked_since = c->clk;
+}
 
-    if (!o) {
-        fprintf(stderr, "[ERROR] fill_snapshot: output pointer is NULL!\n");
+void metrics_wake(SimContext *c, PCB *p)
+{
+    ProcMetrics *m = &c->pm[p->pid];
+    if (m->blocked_since < 0) return;
+    m->blocked += c->clk + 1 - m->blocked_since;
+    m->blocked_since = -1;
+}
+
+/* ready wait: whatever part of the time since arrival the process was
+   neither running nor blocked (waiting for memory or a swap‑in included) */
+static int ready_wait(const ProcMetrics *m, int now)
+{
+    int blocked = m->blocked;
+    if (m->blocked_since >= 0) blocked += now - m->blocked_since;
+    return now - m->arrive - m->cpu - blocked;
+}
+
+/* terminates at the end of the current tick */
+static void metrics_done(SimContext *c, PCB *p)
+{
+    ProcMetrics *m = &c->pm[p->pid];
+    m->done = c->clk + 1;
+    hist_add(&c->h_turn,    m->done - m->arrive);
+    hist_add(&c->h_resp,    m->first_run - m->arrive);
+    hist_add(&c->h_ready,   ready_wait(m, m->done));
+    hist_add(&c->h_blocked, m->blocked);
+}
+
+static void latency(const Histogram *h, SimLatency *o)
+{
+    o->count = h->count;
+    o->mean  = hist_mean(h);
+    o->p50   = hist_quantile(h, 0.50);
+    o->p99   = hist_quantile(h, 0.99);
+    o->p999  = hist_quantile(h, 0.999);
+    o->max   = h->max;
+}
+
+void sim_metrics(SimContext *c, SimMetrics *o)
+{
+    pthread_mutex_lock(&c->mtx);
+    long busy = 0, switches = 0, steals = 0;
+    for (int i = 0; i < c->ncores; i++) {
+        busy     += c->cores[i].busy;
+        switches += c->cores[i].switches;
+        steals   += c->cores[i].steals;
+    }
+    o->clock            = c->clk;
+    o->finished         = c->finished;
+    o->cores            = c->ncores;
+    o->busy_ticks       = busy;
+    o->context_switches = switches;
+    o->migrations       = steals;
+    o->throughput       = c->clk ? (double)c->finished / c->clk : 0;
+    o->cpu_util         = c->clk ? (double)busy / ((double)c->clk * c->ncores) : 0;
+    o->threads          = c->team ? pool_team_threads(c->team) : 1;
+    o->par_ticks        = c->par_ticks;
+    latency(&c->h_turn,    &o->turnaround);
+    latency(&c->h_resp,    &o->response);
+    latency(&c->h_ready,   &o->ready_wait);
+    latency(&c->h_blocked, &o->blocked_wait);
+    pthread_mutex_unlock(&c->mtx);
+}
+
+int sim_core_stats(SimContext *c, SimCoreStats *out, int max)
+{
+    pthread_mutex_lock(&c->mtx);
+    int n = c->ncores < max ? c->ncores : max;
+    for (int i = 0; i < n; i++) {
+        const Core *k = &c->cores[i];
+        out[i].busy_ticks       = k->busy;
+        out[i].context_switches = k->switches;
+        out[i].migrations       = k->steals;
+        out[i].utilization      = c->clk ? (double)k->busy / c->clk : 0;
+    }
+    pthread_mutex_unlock(&c->mtx);
+    return n;
+}
+
+int sim_proc_metrics(SimContext *c, int pid, SimProcMetrics *o)
+{
+    pthread_mutex_lock(&c->mtx);
+    if (pid < 0 || pid >= c->next_pid) {
+        pthread_mutex_unlock(&c->mtx);
+        return -1;
+    }
+    const ProcMetrics *m = &c->pm[pid];
+    int now = m->done >= 0 ? m->done : c->clk;
+    o->pid          = pid;
+    o->arrival      = m->arrive;
+    o->first_run    = m->first_run;
+    o->completion   = m->done;
+    o->cpu          = m->cpu;
+    o->ready_wait   = ready_wait(m, now);
+    o->blocked_wait = now - m->arrive - m->cpu - o->ready_wait;
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+/* ─────── hot‑path profile (empty unless SIM_PROF) ─────── */
+int sim_profile(SimContext *c, SimProfEntry *out, int max)
+{
+#if SIM_PROF
+    double ns = prof_ns_per_unit();
+    int n = max < PROF_N ? max : PROF_N;
+    pthread_mutex_lock(&c->mtx);
+    for (int i = 0; i < n; i++) {
+        const Profile *p = &c->prof;
+        double scale = p->timed[i] ? ns * p->calls[i] / p->timed[i] : 0;
+        out[i].name     = prof_phase_name(i);
+        out[i].calls    = p->calls[i];
+        out[i].total_ns = p->total[i] * scale;
+        out[i].self_ns  = p->self[i] * scale;
+    }
+    pthread_mutex_unlock(&c->mtx);
+    return n > 0 ? n : 0;
+#else
+    (void)c; (void)out; (void)max;
+    return 0;
+#endif
+}
+
+void sim_profile_reset(SimContext *c)
+{
+#if SIM_PROF
+    pthread_mutex_lock(&c->mtx);
+    memset(&c->prof, 0, sizeof c->prof);
+    pthread_mutex_unlock(&c->mtx);
+#else
+    (void)c;
+#endif
+}
+
+static int by_self(const void *x, const void *y)
+{
+    const SimProfEntry *a = x, *b = y;
+    return (a->self_ns < b->self_ns) - (a->self_ns > b->self_ns);
+}
+
+void sim_profile_dump(SimContext *c, FILE *f)
+{
+    SimProfEntry e[PROF_N];
+    int n = sim_profile(c, e, PROF_N);
+    if (!n) {
+        fprintf(f, "profile: compiled out (build without -DNDEBUG, "
+                   "or with -DSIM_PROF=1)\n");
         return;
     }
+    double all = 0;                       /* self times add up to the total */
+    for (int i = 0; i < n; i++) all += e[i].self_ns;
+    qsort(e, n, sizeof *e, by_self);
+
+    fprintf(f, "%-20s %12s %12s %12s %10s %6s\n", "phase", "calls",
+            "total_ms", "self_ms", "self_ns/op", "self%");
+    for (int i = 0; i < n; i++) {
+        if (!e[i].calls) continue;
+        fprintf(f, "%-20s %12ld %12.3f %12.3f %10.1f %6.1f\n", e[i].name,
+                e[i].calls, e[i].total_ns / 1e6, e[i].self_ns / 1e6,
+                e[i].self_ns / e[i].calls, all ? 100 * e[i].self_ns / all : 0);
+    }
+}
+
+/* ─────── snapshot − queues in storage order ─────── */
+
+/* arr with room for at least n elements; grows by doubling */
+static void *snap_grow(void *arr, int *cap, int n, size_t size)
+{
+    if (n <= *cap) return arr;
+    int c = *cap ? *cap : 16;
+    while (c < n) c *= 2;
+    arr = realloc(arr, (size_t)c * size);
+    if (!arr) {
+        perror("sim_step");
+        exit(EXIT_FAILURE);
+    }
+    *cap = c;
+    return arr;
+}
 
+void sim_snapshot_free(SimSnapshot *o)
+{
+    free(o->proc);
+    free(o->ready);
+    free(o->running);
+    for (int r = 0; r < NUM_RESOURCES; r++) free(o->block[r]);
     memset(o, 0, sizeof *o);
-    o->clock      = clk;
-    o->algorithm  = g_alg;
-    o->procs_total= plen;
-
-    // dump each program’s base pointer
-    for (int i = 0; i < plen; i++) {
-            o->proc[i].pid = i;
-            if (!Program_start_locations[i]) {
-                /* not yet loaded: still NEW */
-                o->proc[i].state = NEW;
-                o->proc[i].pc    = 0;
-                o->proc[i].prio  = plist[i].priority;
-                o->proc[i].mem_lo= 0;
-                o->proc[i].mem_hi= 0;
-                continue;
-            }
-            struct MemoryWord *mem = Program_start_locations[i];
-            o->proc[i].state = atoi(mem[1].arg1);
-            o->proc[i].pc    = atoi(mem[3].arg1);
-            o->proc[i].prio  = atoi(mem[2].arg1);
-            o->proc[i].mem_lo= atoi(mem[4].arg1);
-            o->proc[i].mem_hi=      mem[4].arg2;
-    }
-    // ready queue
-    fprintf(stderr,
-        "[DEBUG] ready queue: items=%p, size=%d\n",
-        (void*)S.ready.items, S.ready.size);
-    o->ready_len = S.ready.size;
-    for (int i = 0; i < S.ready.size; i++) {
-        o->ready[i] = atoi(S.ready.items[i].ptr[0].arg1);
+}
+
+static int procs_new(const SimContext *c)
+{
+    return c->plen - c->next_pid - c->rejected;
+}
+
+static void proc_info(const SimContext *c, const PCB *p, SimProcInfo *pi)
+{
+    memset(pi, 0, sizeof *pi);
+    pi->pid   = p->pid;
+    pi->state = p->state;
+    pi->pc    = p->pc;
+    pi->prio  = p->priority;
+    pi->mem_lo= p->mem_lo;
+    pi->mem_hi= p->mem_hi;
+    const PageCounters *pc = c->vm_on ? vm_counters(&c->vm, p->pid) : NULL;
+    if (pc) {
+        pi->page_faults = pc->faults;
+        pi->tlb_hits    = pc->tlb_hits;
+        pi->tlb_misses  = pc->tlb_misses;
+    }
+}
+
+static void fill_snapshot(SimContext *c, SimSnapshot *o)
+{
+    LOG_DEBUG(
+        "fill_snapshot: out=%p, clk=%d, finished=%d, plen=%d\n",
+        (void*)o, c->clk, c->finished, c->plen);
+
+    if (!o) {
+        LOG_ERROR("fill_snapshot: output pointer is NULL!\n");
+        return;
+    }
+    PROF_ENTER(c);
+
+    o->clock      = c->clk;
+    o->algorithm  = c->alg;
+    o->procs_total= c->plen;
+    o->procs_new  = procs_new(c);
+    o->procs_retired = c->finished;
+    o->proc = snap_grow(o->proc, &o->proc_cap, c->act_len, sizeof *o->proc);
+
+    // copy each live PCB straight out of the process table
+    int n = 0;
+    for (int i = 0; i < c->act_len; i++) {
+            const PCB *p = &c->procs[c->active[i]];
+            if (p->state != TERMINATED) proc_info(c, p, &o->proc[n++]);
+    }
+    o->nproc = n;
+    // ready queues, core after core, and what each core ran
+    int nready = 0;
+    for (int i = 0; i < c->ncores; i++) nready += c->cores[i].ready.size;
+    LOG_DEBUG("ready queues: %d cores, size=%d\n", c->ncores, nready);
+    o->ready = snap_grow(o->ready, &o->ready_cap, nready, sizeof *o->ready);
+    o->running = snap_grow(o->running, &o->running_cap, c->ncores,
+                           sizeof *o->running);
+    o->ready_len = 0;
+    for (int i = 0; i < c->ncores; i++) {
+        const MemQueue *q = &c->cores[i].ready;
+        o->ready_len += queue_pids_ordered(q, o->ready + o->ready_len, q->size);
+        o->running[i] = c->cores[i].ran;
     }
+    o->ncores = c->ncores;
 
     // blocked queues & resource availability
     for (int r = 0; r < NUM_RESOURCES; r++) {
-        MemQueue *bq = BlockingQueues[r];
-        
-        // <<< DROP‑IN DEBUG: catch a NULL queue pointer
-        if (!bq) {
-            fprintf(stderr,
-                "[ERROR] BlockingQueues[%d] is NULL! skipping blocked fill\n", r);
-            o->block_len[r] = 0;
-            o->res_free[r]  = false;
-            continue;
-        }
+        MemQueue *bq = &c->blocked[r];
 
-        fprintf(stderr,
-            "[DEBUG] fill_snapshot: BlockingQueues[%d] ➞ %p (size=%d), res_free=%d\n",
+        LOG_DEBUG(
+            "fill_snapshot: blocked[%d] ➞ %p (size=%d), res_free=%d\n",
             r,
             (void*)bq,
             bq->size,
-            Resources_availability[r]
+            c->res_free[r]
         );
-        o->block_len[r] = bq->size;
-        for (int i = 0; i < bq->size; i++) {
-            o->block[r][i] =
-                atoi(bq->items[i].ptr[0].arg1);
+        o->block[r] = snap_grow(o->block[r], &o->block_cap[r], bq->size,
+                                sizeof *o->block[r]);
+        o->block_len[r] = queue_pids_ordered(bq, o->block[r], bq->size);
+        o->res_free[r] = c->res_free[r];
+    }
+    PROF_LEAVE(c, PROF_SNAPSHOT);
+}
+
+/* ─────── published snapshots (triple buffer) ─────── */
+#define PUB_FRESH 4                      /* in pub_mid: not read yet */
+
+int sim_set_publish(SimContext *c, int every)
+{
+    if (every < 0) return -1;
+    pthread_mutex_lock(&c->mtx);
+    c->pub_every = every;
+    c->pub_steps = 0;
+    if (every) publish(c);
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+/* engine side, under c->mtx: fill the back buffer, then trade it for the
+   middle one. The reader never touches either, so this never waits. */
+static void publish(SimContext *c)
+{
+    PROF_ENTER(c);
+    int b = c->pub_back;
+    fill_snapshot(c, &c->pub[b]);
+    c->pub_seq[b] = ++c->pub_count;
+    c->pub_steps  = 0;
+    int old = __atomic_exchange_n(&c->pub_mid, b | PUB_FRESH, __ATOMIC_ACQ_REL);
+    c->pub_back = old & 3;
+    PROF_LEAVE(c, PROF_PUBLISH);
+}
+
+static void copy_snapshot(SimSnapshot *dst, const SimSnapshot *src)
+{
+    SimProcInfo *proc = dst->proc;
+    int *ready = dst->ready, *running = dst->running, *block[NUM_RESOURCES];
+    int  proc_cap = dst->proc_cap, ready_cap = dst->ready_cap;
+    int  running_cap = dst->running_cap;
+    int  block_cap[NUM_RESOURCES];
+    for (int r = 0; r < NUM_RESOURCES; r++) {
+        block[r]     = dst->block[r];
+        block_cap[r] = dst->block_cap[r];
+    }
+
+    *dst = *src;                                /* scalars */
+    dst->proc = snap_grow(proc, &proc_cap, src->nproc, sizeof *proc);
+    if (src->nproc) memcpy(dst->proc, src->proc, src->nproc * sizeof *proc);
+    dst->ready = snap_grow(ready, &ready_cap, src->ready_len, sizeof *ready);
+    if (src->ready_len)
+        memcpy(dst->ready, src->ready, src->ready_len * sizeof *ready);
+    dst->running = snap_grow(running, &running_cap, src->ncores, sizeof *running);
+    if (src->ncores)
+        memcpy(dst->running, src->running, src->ncores * sizeof *running);
+    for (int r = 0; r < NUM_RESOURCES; r++) {
+        dst->block[r] = snap_grow(block[r], &block_cap[r], src->block_len[r],
+                                  sizeof *block[r]);
+        if (src->block_len[r])
+            memcpy(dst->block[r], src->block[r],
+                   src->block_len[r] * sizeof *block[r]);
+        dst->block_cap[r] = block_cap[r];
+    }
+    dst->proc_cap    = proc_cap;
+    dst->ready_cap   = ready_cap;
+    dst->running_cap = running_cap;
+}
+
+/* reader side: take the middle buffer if it is newer than ours, then
+   copy ours out. Readers only serialize among themselves. */
+unsigned long sim_latest(SimContext *c, SimSnapshot *out)
+{
+    pthread_mutex_lock(&c->pub_rd);
+    if (__atomic_load_n(&c->pub_mid, __ATOMIC_ACQUIRE) & PUB_FRESH) {
+        int old = __atomic_exchange_n(&c->pub_mid, c->pub_front, __ATOMIC_ACQ_REL);
+        c->pub_front = old & 3;
+    }
+    unsigned long seq = c->pub_seq[c->pub_front];
+    if (seq) copy_snapshot(out, &c->pub[c->pub_front]);
+    pthread_mutex_unlock(&c->pub_rd);
+    return seq;
+}
+
+/* ─────── delta stream ─────── */
+
+/* next record slot, or NULL while the log is lost. Overflowing drops
+   every pending record: the consumer has to resync anyway. */
+static SimDelta *delta_new(SimContext *c, int kind, int pid)
+{
+    SimDeltaLog *l = &c->dlog;
+    if (!c->d_max || l->lost) return NULL;
+    if (l->len >= c->d_max) {
+        l->len  = 0;
+        l->lost = true;
+        c->d_ntouch = 0;
+        return NULL;
+    }
+    if (l->len == l->cap) {
+        l->cap = l->cap ? 2 * l->cap : 256;
+        l->rec = realloc(l->rec, (size_t)l->cap * sizeof *l->rec);
+        if (!l->rec) { perror("sim_step"); exit(EXIT_FAILURE); }
+    }
+    SimDelta *d = &l->rec[l->len++];
+    memset(d, 0, sizeof *d);
+    d->kind = kind;
+    d->pid  = pid;
+    d->core = -1;
+    return d;
+}
+
+void delta_touch(SimContext *c, int pid)
+{
+    if (!c->d_max || c->dlog.lost) return;
+    if (c->d_ntouch == c->d_touch_cap) {
+        c->d_touch_cap = c->d_touch_cap ? 2 * c->d_touch_cap : 64;
+        c->d_touch = realloc(c->d_touch, c->d_touch_cap * sizeof *c->d_touch);
+        if (!c->d_touch) { perror("sim_step"); exit(EXIT_FAILURE); }
+    }
+    c->d_touch[c->d_ntouch++] = pid;
+}
+
+void delta_res(SimContext *c, int r)
+{
+    SimDelta *d = delta_new(c, SIM_D_RES, -1);
+    if (d) {
+        d->a = r;
+        d->b = c->res_free[r];
+    }
+}
+
+static void delta_retire(SimContext *c, int pid)
+{
+    delta_new(c, SIM_D_RETIRE, pid);
+}
+
+/* the core whose ready or level queue q is; -1: a blocked queue */
+static int queue_core(const SimContext *c, const MemQueue *q)
+{
+    if (q >= c->blocked && q < c->blocked + NUM_RESOURCES) return -1;
+    if (q >= c->mlfq && q < c->mlfq + c->ncores * c->mlfq_levels)
+        return (int)(q - c->mlfq) / c->mlfq_levels;
+    return (int)((const Core *)((const char *)q - offsetof(Core, ready))
+                 - c->cores);
+}
+
+/* MemQueue watch hook: every enqueue/dequeue of the engine's queues.
+   It runs before the change, so an enqueue's rank is where it lands. */
+static void delta_queue(void *arg, const MemQueue *q, bool added,
+                        int pid, int priority)
+{
+    SimContext *c = arg;
+    int id, core = queue_core(c, q), at = 0;
+    if (core < 0) {
+        id = SIM_Q_BLOCKED + (int)(q - c->blocked);
+    } else if (q != &c->cores[core].ready) {
+        id = SIM_Q_MLFQ + (int)(q - c->mlfq) % c->mlfq_levels;
+    } else {
+        id = SIM_Q_READY;
+        for (int k = 0; k < core; k++) at += c->cores[k].ready.size;
+    }
+
+    SimDelta *d = delta_new(c, added ? SIM_D_ENQ : SIM_D_DEQ, pid);
+    if (d) {
+        d->a = id;
+        d->b = priority;
+        if (added) d->c = at + queue_rank(q, priority);
+        d->core = core;
+    }
+    delta_touch(c, pid);
+}
+
+/* the same for a core's own queues, which also feed its load */
+static void core_watch(void *arg, const MemQueue *q, bool added,
+                       int pid, int priority)
+{
+    SimContext *c = arg;
+    load_add(c, &c->cores[queue_core(c, q)], added ? 1 : -1);
+    if (c->d_max) delta_queue(arg, q, added, pid, priority);
+}
+
+/* (un)hook the queues; cores and MLFQ levels are reallocated by sim_init */
+static void watch_queues(SimContext *c)
+{
+    void (*w)(void *, const MemQueue *, bool, int, int) =
+        c->d_max ? delta_queue : NULL;
+    for (int k = 0; k < c->ncores; k++) {
+        c->cores[k].ready.watch = core_watch;
+        c->cores[k].ready.watch_arg = c;
+    }
+    for (int r = 0; r < NUM_RESOURCES; r++) {
+        c->blocked[r].watch = w;
+        c->blocked[r].watch_arg = c;
+    }
+    for (int l = 0; l < c->ncores * c->mlfq_levels; l++) {
+        c->mlfq[l].watch = core_watch;
+        c->mlfq[l].watch_arg = c;
+    }
+}
+
+/* sim_init/sim_reset: what the consumer holds no longer applies */
+static void delta_resync(SimContext *c)
+{
+    c->dlog.len  = 0;
+    c->dlog.lost = c->d_max > 0;
+    c->d_ntouch  = 0;
+    for (int k = 0; k < c->ncores; k++) c->cores[k].ran_sent = c->cores[k].ran;
+    watch_queues(c);
+}
+
+static int by_int(const void *x, const void *y)
+{
+    int a = *(const int *)x, b = *(const int *)y;
+    return (a > b) - (a < b);
+}
+
+/* end of a step: one SIM_D_PROC per touched live process, one SIM_D_CORE
+   per core that ran something else than on the last step, then the tick */
+static void delta_flush(SimContext *c)
+{
+    if (!c->d_max) return;
+    int *t = c->d_touch, n = c->d_ntouch;
+    c->d_ntouch = 0;
+    if (c->dlog.lost) return;
+
+    qsort(t, n, sizeof *t, by_int);
+    for (int i = 0; i < n; i++) {
+        if (i && t[i] == t[i - 1]) continue;
+        const PCB *p = &c->procs[t[i]];
+        if (p->state == TERMINATED) continue;
+        SimDelta *d = delta_new(c, SIM_D_PROC, p->pid);
+        if (!d) return;
+        proc_info(c, p, &d->info);
+    }
+    for (int i = 0; i < c->ncores; i++) {
+        Core *k = &c->cores[i];
+        if (k->ran == k->ran_sent) continue;
+        SimDelta *d = delta_new(c, SIM_D_CORE, k->ran);
+        if (!d) return;
+        d->a = i;
+        k->ran_sent = k->ran;
+    }
+    SimDelta *d = delta_new(c, SIM_D_TICK, -1);
+    if (d) {
+        d->a = c->clk;
+        d->b = procs_new(c);
+        d->c = c->finished;
+    }
+}
+
+int sim_set_deltas(SimContext *c, int max_pending)
+{
+    if (max_pending < 0) return -1;
+    pthread_mutex_lock(&c->mtx);
+    c->d_max = max_pending;
+    delta_resync(c);
+    pthread_mutex_unlock(&c->mtx);
+    return 0;
+}
+
+void sim_take_deltas(SimContext *c, SimDeltaLog *log, SimSnapshot *full)
+{
+    pthread_mutex_lock(&c->mtx);
+    if (full) {
+        fill_snapshot(c, full);
+        c->dlog.len  = 0;
+        c->dlog.lost = false;
+        c->d_ntouch  = 0;
+        for (int k = 0; k < c->ncores; k++) c->cores[k].ran_sent = c->cores[k].ran;
+        log->len  = 0;
+        log->lost = false;
+    } else if (c->dlog.lost) {
+        log->len  = 0;                   /* stays lost until a full take */
+        log->lost = true;
+    } else {
+        SimDeltaLog mine = *log;
+        *log = c->dlog;
+        c->dlog      = mine;
+        c->dlog.len  = 0;
+        c->dlog.lost = false;
+    }
+    pthread_mutex_unlock(&c->mtx);
+}
+
+void sim_delta_log_free(SimDeltaLog *log)
+{
+    free(log->rec);
+    memset(log, 0, sizeof *log);
+}
+
+/* index of pid in proc[] (sorted by pid), or of where it would go */
+static int proc_slot(const SimSnapshot *s, int pid)
+{
+    int lo = 0, hi = s->nproc;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s->proc[mid].pid < pid) lo = mid + 1;
+        else                        hi = mid;
+    }
+    return lo;
+}
+
+static void list_remove(int *arr, int *len, int pid)
+{
+    for (int i = 0; i < *len; i++)
+        if (arr[i] == pid) {
+            memmove(arr + i, arr + i + 1, (*len - i - 1) * sizeof *arr);
+            (*len)--;
+            return;
+        }
+}
+
+void sim_apply_deltas(SimSnapshot *s, const SimDeltaLog *log)
+{
+    for (int k = 0; k < log->len; k++) {
+        const SimDelta *d = &log->rec[k];
+        int i, *len = NULL, **arr = NULL, *cap = NULL;
+
+        switch (d->kind) {
+        case SIM_D_PROC:
+            i = proc_slot(s, d->pid);
+            if (i == s->nproc || s->proc[i].pid != d->pid) {
+                s->proc = snap_grow(s->proc, &s->proc_cap, s->nproc + 1,
+                                    sizeof *s->proc);
+                memmove(s->proc + i + 1, s->proc + i,
+                        (s->nproc - i) * sizeof *s->proc);
+                s->nproc++;
+            }
+            s->proc[i] = d->info;
+            break;
+        case SIM_D_RETIRE:
+            i = proc_slot(s, d->pid);
+            if (i < s->nproc && s->proc[i].pid == d->pid) {
+                memmove(s->proc + i, s->proc + i + 1,
+                        (s->nproc - i - 1) * sizeof *s->proc);
+                s->nproc--;
+            }
+            break;
+        case SIM_D_ENQ:
+        case SIM_D_DEQ:
+            if (d->a == SIM_Q_READY) {
+                arr = &s->ready; len = &s->ready_len; cap = &s->ready_cap;
+            } else if (d->a < SIM_Q_MLFQ) {
+                int r = d->a - SIM_Q_BLOCKED;
+                arr = &s->block[r]; len = &s->block_len[r]; cap = &s->block_cap[r];
+            } else {
+                break;                   /* MLFQ levels are not in snapshots */
+            }
+            if (d->kind == SIM_D_DEQ) {
+                list_remove(*arr, len, d->pid);
+            } else {
+                *arr = snap_grow(*arr, cap, *len + 1, sizeof **arr);
+                i = d->c < *len ? d->c : *len;
+                memmove(*arr + i + 1, *arr + i, (*len - i) * sizeof **arr);
+                (*arr)[i] = d->pid;
+                (*len)++;
+            }
+            break;
+        case SIM_D_RES:
+            s->res_free[d->a] = d->b;
+            break;
+        case SIM_D_CORE:
+            if (d->a < s->ncores) s->running[d->a] = d->pid;
+            break;
+        case SIM_D_TICK:
+            s->clock         = d->a;
+            s->procs_new     = d->b;
+            s->procs_retired = d->c;
+            break;
         }
-        o->res_free[r] = Resources_availability[r];
     }
 }
@@ -1,35 +1,343 @@
 #ifndef SIM_H
 #define SIM_H
 
+#include <stdio.h>
 #include "program.h"
-#include "utilities.h"   /* for MAX_PROGRAMS, NUM_RESOURCES, enums, MemoryWord */
+#include "utilities.h"   /* for NUM_RESOURCES, enums, MemoryWord */
+#include "mem_alloc.h"   /* AllocPolicy */
+#include "paging.h"      /* ReplPolicy */
 
-extern MemQueue  BlockingQueuesNotPtrs[NUM_RESOURCES];
-extern MemQueue *BlockingQueues[NUM_RESOURCES];
-extern bool      Resources_availability[NUM_RESOURCES];
-extern struct MemoryWord *Program_start_locations[MAX_PROGRAMS];
+/* MLFQ shape: default level count and the most sim_set_mlfq accepts */
+#define SIM_MLFQ_LEVELS     4
+#define SIM_MLFQ_MAX_LEVELS 4096
 
+/* simulated CPUs: the most sim_set_cores accepts */
+#define SIM_MAX_CORES       1024
+
+/* simulated memory: default size in words (one image is 9 + its lines) */
+#define SIM_MEM_WORDS       (1 << 20)
+
+/* one independent simulation; every engine call takes its handle */
+typedef struct SimContext SimContext;
+
+/* mem_lo/mem_hi are -1 while the image is swapped out; the paging
+   counters stay 0 unless paging is on */
 typedef struct {
-    int pid, state, pc, prio, mem_lo, mem_hi;
+    int  pid, state, pc, prio, mem_lo, mem_hi;
+    long page_faults, tlb_hits, tlb_misses;
 } SimProcInfo;
 
+/* The arrays belong to the snapshot and are grown by the engine: start
+   from a zeroed SimSnapshot, reuse it across steps and release it with
+   sim_snapshot_free(). */
 typedef struct {
     int clock;                   /* global time */
     int algorithm;               /* FCFS, RR, or MLFQ */
-    int procs_total;
+    int procs_total;             /* programs in the workload */
+    int procs_new;               /* not admitted yet */
+    int procs_retired;           /* terminated */
 
-    SimProcInfo proc[MAX_PROGRAMS];
+    SimProcInfo *proc;           /* the nproc live processes, by pid */
+    int          nproc;
 
-    int ready[MAX_PROGRAMS], ready_len;
-    int block[NUM_RESOURCES][MAX_PROGRAMS], block_len[NUM_RESOURCES];
+    /* queues in dequeue order (priority, then arrival) */
+    int *ready, ready_len;       /* every core's ready queue, in core order */
+    int *block[NUM_RESOURCES], block_len[NUM_RESOURCES];
 
     bool res_free[NUM_RESOURCES];
+
+    int *running, ncores;        /* pid each core ran on the last tick, -1: idle */
+
+    int proc_cap, ready_cap, block_cap[NUM_RESOURCES], running_cap;
 } SimSnapshot;
 
-/* Public API: initialize, run one tick, reset */
-void sim_init (struct program list[], int n,
+/* ——— delta stream: what one step changed ——— */
+
+/* queue ids in delta records */
+#define SIM_Q_READY    0
+#define SIM_Q_BLOCKED  1                        /* + resource */
+#define SIM_Q_MLFQ     (1 + NUM_RESOURCES)      /* + level */
+
+typedef enum {
+    SIM_D_ENQ,        /* pid joined queue a with priority b, at index c
+                         of the snapshot's array */
+    SIM_D_DEQ,        /* pid left queue a */
+    SIM_D_RES,        /* resource a is now free (b = 1) or locked (b = 0) */
+    SIM_D_RETIRE,     /* pid terminated and left the live set */
+    SIM_D_PROC,       /* pid is new or changed; info is its current state */
+    SIM_D_TICK,       /* closes a step: a = clock, b = procs_new,
+                         c = procs_retired */
+    SIM_D_CORE        /* core a ran pid on this step (-1: it idled) */
+} SimDeltaKind;
+
+/* Within a step, queue, resource and retire records come in the order
+   things happened, then one SIM_D_PROC per touched live process, one
+   SIM_D_CORE per core that ran something else than on the step before,
+   then SIM_D_TICK. Every core's ready queue is SIM_Q_READY, and an
+   MLFQ record names the level; `core` says whose queue it was. A ready
+   ENQ index counts the earlier cores' queues too, as ready[] does. */
+typedef struct {
+    int         kind, pid;
+    int         a, b, c;
+    int         core;            /* ENQ/DEQ of a ready or MLFQ queue; else -1 */
+    SimProcInfo info;            /* SIM_D_PROC only */
+} SimDelta;
+
+typedef struct {
+    SimDelta *rec;
+    int       len, cap;
+    bool      lost;              /* records were dropped: resync (see below) */
+} SimDeltaLog;
+
+/* aggregate result of a bulk run */
+typedef struct {
+    long steps;                  /* scheduling steps taken */
+    long ticks;                  /* clock advance (idle skips included) */
+    int  clock;
+    int  finished, procs_total;
+    int  alive;                  /* 1 while processes remain */
+} SimRunStats;
+
+/* optional sampling for bulk runs: every `every` steps one snapshot is
+   written to buf[len++] until `cap` is reached (zero buf first; each
+   entry is then freed with sim_snapshot_free) */
+typedef struct {
+    SimSnapshot *buf;
+    int          cap, every;
+    int          len;            /* set by the engine */
+} SimSampler;
+
+/* simulated memory after the last step */
+typedef struct {
+    int    policy;               /* AllocPolicy */
+    int    capacity;             /* words */
+    long   in_use, free_words;
+    int    free_blocks, largest_free;
+    double ext_frag;             /* 1 - largest_free / free_words */
+    long   internal_waste;       /* words reserved by rounding, not asked for */
+    long   allocs, frees, failures;
+    long   compactions, words_moved;
+    double alloc_ns_avg;         /* host time per allocator call */
+    long   alloc_ns_max;
+    int    pending;              /* arrived, waiting for memory */
+    int    rejected;             /* larger than all of memory; dropped */
+    long   delayed;              /* arrivals that had to wait */
+    long   wait_ticks_total;
+    int    wait_ticks_max;
+    /* swapping (sim_set_swap) */
+    long   swap_outs, swap_ins;
+    long   swap_words_out, swap_words_in;   /* image sizes moved */
+    long   swap_bytes_out, swap_bytes_in;   /* swap file traffic */
+    long   swap_wait_ticks;                 /* dispatch to back in memory */
+    int    swapped;                         /* images out right now */
+    /* paging (sim_set_paging) */
+    int    frames, frames_free;
+    long   page_faults, evictions, writebacks;
+    long   tlb_hits, tlb_misses, tlb_flushes;
+} SimMemStats;
+
+/* one distribution in ticks over the finished processes; quantiles come
+   from log buckets and are within 1/16 of the exact value */
+typedef struct {
+    long   count;
+    double mean;
+    int    p50, p99, p999, max;
+} SimLatency;
+
+/* Run metrics, kept up to date by the engine as it steps. Turnaround
+   runs from arrival (in the workload, or the sim_submit tick if later)
+   to the end of the last tick; response to the first dispatch. Ready
+   wait is the time a process neither ran nor was blocked on a resource,
+   so it includes waiting for memory and swap‑ins. */
+typedef struct {
+    int    clock, finished;
+    int    cores;
+    long   busy_ticks;               /* core ticks some process ran */
+    long   context_switches;         /* runs of a process other than the
+                                        last one on that core */
+    long   migrations;               /* processes stolen by idle cores */
+    double throughput;               /* finished processes per tick */
+    double cpu_util;                 /* busy_ticks / (clock * cores) */
+    SimLatency turnaround, response, ready_wait, blocked_wait;
+    /* host side (sim_set_threads); the only fields that vary with it */
+    int    threads;
+    long   par_ticks;                /* ticks whose cores stepped in parallel */
+} SimMetrics;
+
+/* one simulated CPU over the current run */
+typedef struct {
+    long   busy_ticks, context_switches;
+    long   migrations;               /* processes it took from other cores */
+    double utilization;              /* busy_ticks / clock */
+} SimCoreStats;
+
+/* one process so far; -1 for what has not happened yet */
+typedef struct {
+    int pid;
+    int arrival, first_run, completion;
+    int cpu, ready_wait, blocked_wait;        /* ticks */
+} SimProcMetrics;
+
+/* return non‑zero to stop a sim_run_until() after the current step */
+typedef int (*SimStopFn)(const SimRunStats *so_far, void *arg);
+
+/* Context lifetime. Separate contexts share nothing and may be stepped
+   from different threads at the same time. */
+SimContext *sim_create (void);
+void        sim_destroy(SimContext *ctx);
+
+/* where the simulated programs read `input` from and print to
+   (defaults: stdin / stdout; out == NULL discards program output,
+   in == NULL makes every `input` read as end of input) */
+void sim_set_io(SimContext *ctx, FILE *in, FILE *out);
+
+/* MLFQ levels and ticks per level, used from the next sim_init on.
+   quanta == NULL gives level l a quantum of 2^l (capped at 2^30).
+   Returns 0, or -1 if levels is outside 1..SIM_MLFQ_MAX_LEVELS or a
+   quantum is below 1. */
+int  sim_set_mlfq(SimContext *ctx, int levels, const int *quanta);
+
+/* Simulated CPUs, used from the next sim_init on (default 1). Every
+   tick each core runs one instruction of its own processes, cores in
+   index order, with the algorithm and quantum of the run; FCFS and RR
+   keep a ready queue per core, MLFQ a set of levels per core. An
+   arrival goes to the core with the fewest processes to run, a
+   process woken up or swapped back in returns to the core it last ran
+   on, and a core left with nothing to run steals one waiting process
+   from the core with the most. Semaphores and memory are shared.
+   Returns 0, or -1 for n outside 1..SIM_MAX_CORES. */
+int  sim_set_cores(SimContext *ctx, int n);
+
+/* Host threads that step the simulated cores (default 1; 0: one per
+   CPU), taking effect at once. Every tick is planned first: cores whose
+   next instruction only touches their own queues and process step in
+   parallel, then the rest in core order, so the results are exactly
+   those of one thread. A core that starts a swap‑in, or steals while
+   some core has a process to spare, steps in order with every core
+   after it; one that would find nothing to steal sits the tick out. A
+   tick steps on one thread with paging, the delta stream, tracing or
+   debug logging on, or when fewer than 64 cores can go in parallel;
+   SimMetrics.par_ticks counts the ticks that went parallel.
+   Returns 0, or -1 for n < 0. */
+int  sim_set_threads(SimContext *ctx, int n);
+
+/* Size and placement policy of simulated memory, used from the next
+   sim_init on. Terminated processes give their words back; an arrival
+   that does not fit waits (in arrival order) until it does. With
+   `compact`, the fit policies slide live images down to make room
+   before making an arrival wait; buddy never compacts.
+   Returns 0, or -1 for fewer than BUDDY_MIN_WORDS words or a bad policy. */
+int  sim_set_memory(SimContext *ctx, int words, AllocPolicy policy, bool compact);
+void sim_mem_stats (SimContext *ctx, SimMemStats *out);
+
+/* Medium‑term scheduling, used from the next sim_init on. When an
+   image does not fit, blocked images and then the lowest‑priority ready
+   ones are written to a swap file (created in `dir`, NULL: $TMPDIR or
+   /tmp) until it does. A swapped‑out process is brought back when it is
+   dispatched; every transfer keeps the single swap device busy for
+   `latency` ticks. Returns 0, or -1 if enabled with latency < 1. */
+int  sim_set_swap(SimContext *ctx, bool enable, int latency, const char *dir);
+
+/* Paged memory, used from the next sim_init on (frames == 0: off, the
+   default). Every process gets its own address space of page_words‑word
+   pages backed by `frames` shared frames and a `tlb_entries` TLB that is
+   flushed on every process switch. Each instruction references its code
+   word and the variables it names; with `fault_stall` an instruction
+   that page‑faults is retried on the process's next tick (once).
+   Contiguous placement, compaction and swapping are bypassed while
+   paging is on. Returns 0, or -1 for frames < 3 (one instruction may
+   touch three pages), page_words < 1 or tlb_entries < 1. */
+int  sim_set_paging(SimContext *ctx, int frames, int page_words,
+                    int tlb_entries, ReplPolicy policy, bool fault_stall);
+
+/* Public API: initialize, run one tick, reset. sim_init copies `list`. */
+void sim_init (SimContext *ctx, struct program list[], int n,
                SCHEDULING_ALGORITHM alg, int quantum);
-int  sim_step (SimSnapshot *out);  /* returns 1 while processes remain */
-void sim_reset(void);
+int  sim_step (SimContext *ctx, SimSnapshot *out);  /* returns 1 while processes remain;
+                                                       out may be NULL */
+void sim_reset(SimContext *ctx);
+
+/* Appends programs to the running workload (after sim_init, between
+   steps). Arrivals before the current clock arrive now. Lets a
+   generator feed a long run in batches instead of one huge list.
+   Returns 0, or -1 before sim_init or for n < 0. */
+int  sim_submit(SimContext *ctx, const struct program *list, int n);
+
+/* Program text kept in memory under `name` (at most 49 characters);
+   workload entries with that name use it instead of reading a file.
+   Definitions last for the context's lifetime; redefining a name takes
+   effect from the next sim_init. Returns 0, or -1 for an empty text or
+   a name that is too long. */
+int  sim_define_program(SimContext *ctx, const char *name, const char *text);
+
+/* Metrics of the current run (reset by sim_init/sim_reset). The
+   accounting costs a few counter updates per tick and is always on. */
+void sim_metrics(SimContext *ctx, SimMetrics *out);
+/* Returns 0, or -1 for a pid that was never admitted. */
+int  sim_proc_metrics(SimContext *ctx, int pid, SimProcMetrics *out);
+/* Writes up to max entries, one per core, and returns how many. */
+int  sim_core_stats(SimContext *ctx, SimCoreStats *out, int max);
+
+/* Hot‑path profile (core/prof.h): calls and host time of each phase of
+   a step and of each opcode handler, since sim_create or the last
+   sim_profile_reset. Only builds with SIM_PROF (debug builds, by
+   default) keep it. */
+typedef struct {
+    const char *name;
+    long        calls;
+    double      total_ns;        /* enclosed phases included */
+    double      self_ns;         /* without them */
+} SimProfEntry;
+
+/* Writes up to max entries, one per phase in ProfPhase order, and
+   returns how many; 0 when profiling is compiled out. */
+int  sim_profile      (SimContext *ctx, SimProfEntry *out, int max);
+void sim_profile_reset(SimContext *ctx);
+/* the profile as a table, busiest phases by self time first */
+void sim_profile_dump (SimContext *ctx, FILE *f);
+
+/* frees the snapshot's arrays and zeroes it for reuse */
+void sim_snapshot_free(SimSnapshot *snap);
+
+/* Published state for other threads. With every > 0 the engine publishes
+   a snapshot after every `every` steps (and when a run ends, and on
+   sim_init/sim_reset); 0, the default, turns it off. Returns 0, or -1
+   for every < 0. */
+int  sim_set_publish(SimContext *ctx, int every);
+/* Copies the newest published snapshot into out (grown as in sim_step)
+   without taking the engine lock, so it can be called from any thread
+   while the engine runs. Returns its publication number (1, 2, ...),
+   unchanged if nothing new was published, or 0 if nothing was yet. */
+unsigned long sim_latest(SimContext *ctx, SimSnapshot *out);
+
+/* Delta stream for one consumer per context. With max_pending > 0 every
+   step logs what it changed; if more than max_pending records pile up
+   before they are taken they are dropped and the next take reports
+   `lost`. 0, the default, turns the stream off. sim_init and sim_reset
+   also count as lost. Returns 0, or -1 for max_pending < 0. */
+int  sim_set_deltas(SimContext *ctx, int max_pending);
+/* Moves the pending records into log (old contents discarded, storage
+   reused; the engine only swaps buffers). With full != NULL the pending
+   records are dropped instead and full gets the current state, which
+   later records apply to: do that first and whenever log->lost is set. */
+void sim_take_deltas(SimContext *ctx, SimDeltaLog *log, SimSnapshot *full);
+void sim_delta_log_free(SimDeltaLog *log);
+/* Applies records to a snapshot (the `full` of a take). A process
+   record costs a binary search of proc[]; a retire, or a queue record,
+   also shifts the rest of that array. Records for MLFQ levels, which
+   snapshots do not show, are skipped. */
+void sim_apply_deltas(SimSnapshot *snap, const SimDeltaLog *log);
+
+/* Bulk stepping: take the lock once and skip snapshot building.
+   `sample` and `out` may be NULL; all return 1 while processes remain. */
+int  sim_step_n   (SimContext *ctx, long n, SimSampler *sample, SimRunStats *out);
+int  sim_run_until(SimContext *ctx, SimStopFn stop, void *arg,
+                   SimSampler *sample, SimRunStats *out);
+int  sim_run      (SimContext *ctx, SimSampler *sample, SimRunStats *out);   /* to completion */
+
+/* Word view of one process image (PCB words, variables, program text,
+   EOI) as the old memory layout showed it; built on demand for display.
+   Returns the number of words written (at most max), -1 for an unknown pid. */
+int  sim_render_memory(SimContext *ctx, int pid, struct MemoryWord *out, int max);
 
 #endif /* SIM_H */
@@ -0,0 +1,259 @@
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+/*
+ * Engine internals shared by the scheduler (sim.c) and the interpreter
+ * (old_main.c). Front‑ends only see the opaque SimContext from sim.h.
+ */
+#include <pthread.h>
+#include "sim.h"
+#include "timing_wheel.h"
+#include "mem_alloc.h"
+#include "swap_file.h"
+#include "paging.h"
+#include "histogram.h"
+#include "prof.h"
+#include "work_pool.h"
+#include "log.h"
+
+/* one entry of the arrival list */
+typedef struct {
+    int time, idx;            /* tick, plist index */
+} Arrival;
+
+/* A program file decoded once per context; every process started from it
+   shares the code and keeps only its PCB (with variables) of its own. */
+typedef struct {
+    char         name[50];
+    Instruction *code;        /* OP_EOI terminated */
+    int          ninstr;
+    char        *text;        /* source lines, NUL separated (display only) */
+    int         *line;        /* offset of line i in text */
+} ProgramImage;
+
+/* Accounting of one process, indexed by pid next to the process table.
+   Times are ticks; blocked_since is -1 while it is not blocked. */
+typedef struct {
+    int arrive, first_run, done;              /* -1 until it happens */
+    int cpu, blocked, blocked_since;
+} ProcMetrics;
+
+/* One simulated CPU. Every core schedules the processes homed on it:
+   FCFS and RR from `ready`, MLFQ from its own level queues (levels and
+   quanta are the context's). Bit l of mlfq_bits is set while mlfq[l] is
+   non‑empty and bit w of mlfq_summary while mlfq_bits[w] is non‑zero,
+   so the highest non‑empty level is two bit scans away. */
+typedef struct {
+    MemQueue  ready;                          /* FCFS + RR */
+    int       cur_q;                          /* RR */
+    PCB      *running;
+    PCB      *ml_running;                     /* MLFQ (level + remaining
+                                                 quantum live in the PCB) */
+    MemQueue *mlfq;                           /* into SimContext.mlfq */
+    uint64_t *mlfq_bits;
+    uint64_t  mlfq_summary;
+
+    /* metrics: busy ticks, dispatches of a process other than the one
+       that ran last, processes taken from other cores */
+    long      busy, switches, steals;
+    int       last_pid;                       /* -1: none yet */
+    int       ran, ran_sent;                  /* pid run this tick (-1: idle);
+                                                 as of the last delta flush */
+    int       load;                           /* processes queued on it or
+                                                 running (the load index) */
+} Core;
+
+/* program text from sim_define_program(); kept across runs */
+typedef struct {
+    char  name[50];
+    char *text;
+} ProgramSource;
+
+struct SimContext {
+    int             id;          /* tags trace events */
+    pthread_mutex_t mtx;
+
+    /* workload (the engine keeps its own copy of the program list;
+       sim_submit appends to it) */
+    struct program *plist;
+    int             plen, plist_cap;
+    Arrival        *arrivals;    /* sorted by time; due from arr_next on */
+    int             narrivals, arr_next, arr_cap;
+    SCHEDULING_ALGORITHM alg;
+    int             quantum;
+
+    int clk;
+    int finished;
+
+    /* decoded programs + process table. Word addresses (mem_lo/mem_hi)
+       come from the allocator but nothing is stored at them. sim_init
+       sizes the table for one process per program, so PCB pointers stay
+       valid for a whole run. */
+    ProgramImage      *images;
+    int                nimages, images_cap;
+    ProgramSource     *srcs;
+    int                nsrcs, srcs_cap;
+    PCB               *procs;                 /* indexed by pid */
+    ProcMetrics       *pm;                    /* same, procs_cap entries */
+    int               *home;                  /* same: the pid's core */
+    int                procs_cap, next_pid;
+
+    /* process sets. New: the arrival list from arr_next on plus
+       `pending`. Active: admitted, in pid order; terminated entries are
+       skipped and dropped once they make up half the list. Retired:
+       `finished`, never visited again. */
+    int               *active;
+    int                act_len, act_cap, act_dead;
+
+    /* simulated memory; arrivals that do not fit wait in `pending`
+       (plist index + arrival tick, oldest first) */
+    MemAllocator       mem;
+    int                mem_words;             /* from sim_set_memory() */
+    AllocPolicy        mem_policy;
+    bool               mem_compact;
+    int               *pending, *pending_since;
+    int                pend_head, pend_len, pend_cap;
+    long               pend_blocked;          /* frees count when the head
+                                                 last failed, else -1 */
+    int                rejected;
+    long               compactions, words_moved;
+    long               delayed, wait_total;
+    int                wait_max;
+
+    /* swapping; a process is swapped out while p->swap > 0 and
+       mem_lo < 0, and being read back while p->swap > 0 and mem_lo >= 0 */
+    SwapFile           swap;
+    bool               swap_on, swap_want;
+    int                swap_latency, swap_want_latency;
+    char              *swap_dir;
+    int                swap_busy;             /* tick the device frees up */
+    int                swapped;
+    long               swap_outs, swap_ins;
+    long               swap_words_out, swap_words_in, swap_wait;
+
+    /* paging (replaces contiguous placement while vm_on) */
+    PageSystem         vm;
+    bool               vm_on, vm_stall;
+    int                vm_frames, vm_page_words, vm_tlb;  /* configured */
+    ReplPolicy         vm_policy;
+    bool               vm_want_stall;
+    int                vm_stall_pid, vm_stall_pc;         /* last retried */
+
+    /* simulated CPUs, stepped in index order every tick. Arrivals go to
+       the least loaded core, wake‑ups and swap‑ins to the process's home
+       core, and a core with nothing to run steals from the busiest one. */
+    Core       *cores;
+    int         ncores;
+    int         want_cores;                   /* sim_set_cores(); next sim_init */
+
+    /* load index: a tournament tree over the cores by load, node 1 the
+       root and node ld_leaves + k core k's leaf. ld_min holds the least
+       loaded core of each subtree and ld_max the most loaded one, the
+       lowest index among equals; -1 past the last core. */
+    int        *ld_min, *ld_max, ld_leaves;
+    int         nbusy, nspare;                /* cores with load > 0, > 1 */
+
+    /* host threads stepping the cores (sim_set_threads; NULL: just the
+       caller). Each tick is planned first: the cores whose step touches
+       only their own queues and the process they run (par_local) step in
+       parallel, the others after them in core order. */
+    PoolTeam   *team;
+    uint8_t    *par_local;                    /* per core: PAR_* (sim.c) */
+    int        *par_list, par_nlocal;         /* the local cores, ascending */
+    int        *par_pids, par_pids_cap;       /* scratch for blocked pids */
+    long        par_ticks;                    /* ticks stepped in parallel */
+    bool        par_stepping;                 /* the local cores are */
+
+    /* shared queues */
+    MemQueue    blocked[NUM_RESOURCES];
+    bool        res_free[NUM_RESOURCES];
+    TimingWheel events;                       /* swap‑ins, keyed by tick */
+
+    /* MLFQ shape; the level queues of core k are mlfq[k * mlfq_levels ..]
+       and its bitmap words mlfq_bits[k * mlfq_words ..] */
+    int       mlfq_levels, mlfq_words;
+    int      *mlfq_quanta;                    /* ticks per level */
+    MemQueue *mlfq;
+    uint64_t *mlfq_bits;
+    /* from sim_set_mlfq(); applied by the next sim_init() */
+    int       want_levels;
+    int      *want_quanta;
+
+    /* metrics: distributions over finished processes (the counters are
+       per core) */
+    Histogram h_turn, h_resp, h_ready, h_blocked;
+
+#if SIM_PROF
+    Profile   prof;                           /* since create / last reset */
+#endif
+
+    /* where simulated programs read input and print; out == NULL is silent */
+    FILE *in, *out;
+
+    /* Published state, triple buffered. The engine fills pub[pub_back]
+       and swaps it with the middle buffer (pub_mid, atomic, index plus a
+       fresh bit); a reader swaps the middle buffer with pub[pub_front]
+       when it is fresh. Each side owns its buffer, so the engine never
+       waits for readers and readers never take c->mtx. */
+    SimSnapshot     pub[3];
+    unsigned long   pub_seq[3];               /* publication number */
+    unsigned long   pub_count;
+    int             pub_back, pub_mid, pub_front;
+    int             pub_every, pub_steps;     /* interval, steps since */
+    pthread_mutex_t pub_rd;                   /* between readers only */
+
+    /* delta stream (sim_set_deltas); d_touch lists the pids whose
+       SIM_D_PROC is due at the end of the step */
+    SimDeltaLog     dlog;
+    int             d_max;                    /* 0: off */
+    int            *d_touch, d_ntouch, d_touch_cap;
+};
+
+#define CTX_TRACE(c, kind, pid, a, b) TRACE((c)->id, (c)->clk, kind, pid, a, b)
+
+/* the core a process belongs to */
+static inline Core *proc_core(const SimContext *c, const PCB *p)
+{
+    return &c->cores[c->home[p->pid]];
+}
+
+/* ——— MLFQ level queues of one core (sim.c); keep its bitmap in sync ——— */
+void  mlfq_push (Core *k, PCB *p, int lvl, int priority);
+PCB  *mlfq_pop  (Core *k, int lvl);
+int   mlfq_first(const Core *k);                /* -1 if all empty */
+void  mlfq_sync (Core *k, int lvl);             /* after direct queue use */
+
+/* ——— process sets (sim.c) ——— */
+void  proc_admit (SimContext *c, PCB *p);       /* just created */
+void  proc_retire(SimContext *c, PCB *p);       /* just terminated */
+
+/* ——— metrics (sim.c) ——— */
+void  metrics_run  (SimContext *c, PCB *p);     /* p runs this tick */
+void  metrics_block(SimContext *c, PCB *p);     /* p starts waiting */
+void  metrics_wake (SimContext *c, PCB *p);     /* p is ready again */
+
+/* ——— delta stream (sim.c); no‑ops while it is off ——— */
+void  delta_touch(SimContext *c, int pid);      /* pid's info changed */
+void  delta_res  (SimContext *c, int r);        /* res_free[r] changed */
+
+/* ——— simulated memory (sim.c) ——— */
+int   mem_place  (SimContext *c, int words);    /* -1: no room right now */
+void  mem_release(SimContext *c, PCB *p);       /* on termination */
+/* paging: references of the instruction at p->pc; true if it has to
+   wait for a page fault and be retried */
+bool  vm_refs    (SimContext *c, PCB *p, const Instruction *in);
+
+/* text defined for a program name, or NULL to read the file (sim.c) */
+const char *program_source(const SimContext *c, const char *name);
+
+/* ——— interpreter (old_main.c) ——— */
+int       image_words(SimContext *c, int idx);  /* words plist[idx] needs */
+PCB      *add_program_to_memory(SimContext *c, int idx, MemQueue *queue_to_be_used);
+void      free_images(SimContext *c);
+void      free_vars(PCB *p);
+int       render_process(const SimContext *c, const PCB *p,
+                         struct MemoryWord *out, int max);
+bool      execute_an_instruction(SimContext *c, PCB *p);
+bool      can_execute_instruction(SimContext *c, PCB *p);
+MemQueue *get_blocking_queue(SimContext *c, PCB *p);
+
+#endif /* SIM_INTERNAL_H */
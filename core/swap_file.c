@@ -0,0 +1,122 @@
+/*  core/swap_file.c  – mmap‑backed slots for swapped‑out process images  */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "swap_file.h"
+
+#define SWAP_INITIAL_SLOTS 64
+
+void swap_init(SwapFile *s)
+{
+    memset(s, 0, sizeof *s);
+    s->fd = -1;
+}
+
+/* remap the file at twice its size (or the initial size) */
+static int swap_grow(SwapFile *s)
+{
+    int    n    = s->nslots ? 2 * s->nslots : SWAP_INITIAL_SLOTS;
+    size_t size = (size_t)n * SWAP_SLOT_BYTES;
+    if (ftruncate(s->fd, (off_t)size) != 0) return -1;
+
+    char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    if (s->map) munmap(s->map, s->size);
+    s->map    = map;
+    s->size   = size;
+    s->nslots = n;
+    return 0;
+}
+
+int swap_open(SwapFile *s, const char *dir)
+{
+    if (!dir) dir = getenv("TMPDIR");
+    if (!dir || !*dir) dir = "/tmp";
+
+    char path[4096];
+    snprintf(path, sizeof path, "%s/simswap-XXXXXX", dir);
+    int fd = mkstemp(path);
+    if (fd < 0) return -1;
+    unlink(path);                 /* gone from the directory once closed */
+
+    swap_init(s);
+    s->fd = fd;
+    if (swap_grow(s) != 0) {
+        int err = errno;
+        swap_close(s);
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+void swap_close(SwapFile *s)
+{
+    if (s->map) munmap(s->map, s->size);
+    if (s->fd >= 0) close(s->fd);
+    free(s->free_slots);
+    swap_init(s);
+}
+
+void swap_clear(SwapFile *s)
+{
+    s->top   = 0;
+    s->nfree = 0;
+}
+
+int swap_put(SwapFile *s, const VarSlot vars[NUM_VAR_SLOTS])
+{
+    int slot;
+    if (s->nfree) {
+        slot = s->free_slots[--s->nfree];
+    } else {
+        if (s->top == s->nslots && swap_grow(s) != 0) return -1;
+        slot = s->top++;
+    }
+
+    /* per variable: ival, set, len, then len bytes of text */
+    char *w = s->map + (size_t)slot * SWAP_SLOT_BYTES;
+    for (int i = 0; i < NUM_VAR_SLOTS; i++) {
+        const VarSlot *v = &vars[i];
+        memcpy(w, &v->ival, sizeof v->ival);
+        w += sizeof v->ival;
+        *w++ = (char)v->set;
+        *w++ = (char)v->len;
+        memcpy(w, v->heap ? v->heap : v->text, v->len);
+        w += v->len;
+    }
+    s->bytes_written += w - (s->map + (size_t)slot * SWAP_SLOT_BYTES);
+    return slot;
+}
+
+void swap_get(SwapFile *s, int slot, VarSlot vars[NUM_VAR_SLOTS])
+{
+    const char *r = s->map + (size_t)slot * SWAP_SLOT_BYTES;
+    for (int i = 0; i < NUM_VAR_SLOTS; i++) {
+        VarSlot *v = &vars[i];
+        memset(v, 0, sizeof *v);
+        memcpy(&v->ival, r, sizeof v->ival);
+        r += sizeof v->ival;
+        v->set = (uint8_t)*r++;
+        v->len = (uint8_t)*r++;
+        char *dst = v->text;
+        if (v->len >= VAR_INLINE) {
+            dst = v->heap = malloc(v->len + 1);
+            if (!dst) { perror("swap_get"); exit(EXIT_FAILURE); }
+        }
+        memcpy(dst, r, v->len);
+        dst[v->len] = '\0';
+        r += v->len;
+    }
+    s->bytes_read += r - (s->map + (size_t)slot * SWAP_SLOT_BYTES);
+
+    if (s->nfree == s->cap_free) {
+        s->cap_free = s->cap_free ? 2 * s->cap_free : 64;
+        s->free_slots = realloc(s->free_slots, s->cap_free * sizeof *s->free_slots);
+        if (!s->free_slots) { perror("swap_get"); exit(EXIT_FAILURE); }
+    }
+    s->free_slots[s->nfree++] = slot;
+}
@@ -0,0 +1,40 @@
+#ifndef SWAP_FILE_H
+#define SWAP_FILE_H
+/*
+ * Backing store for swapped‑out process images: an unlinked temporary
+ * file mapped into memory, cut into fixed slots. A slot holds the
+ * variables of one process (the code is shared and never swapped; the
+ * PCB stays in the process table). The file doubles when it runs out of
+ * slots.
+ */
+#include <stddef.h>
+#include "utilities.h"   /* VarSlot, NUM_VAR_SLOTS */
+
+/* three variables of at most 99 characters plus their headers */
+#define SWAP_SLOT_BYTES 320
+
+typedef struct {
+    int     fd;           /* -1 until swap_open() */
+    char   *map;
+    size_t  size;         /* bytes mapped */
+    int     nslots;
+    int     top;          /* slots handed out at least once */
+    int    *free_slots;   /* returned slots, reused first */
+    int     nfree, cap_free;
+    long    bytes_written, bytes_read;
+} SwapFile;
+
+void swap_init (SwapFile *s);                   /* closed, nothing mapped */
+/* create the file in `dir` (NULL: $TMPDIR or /tmp); 0 or -1 with errno */
+int  swap_open (SwapFile *s, const char *dir);
+void swap_close(SwapFile *s);
+void swap_clear(SwapFile *s);                   /* every slot free again */
+
+/* Copies vars into a free slot and returns it, or -1 if the file could
+   not grow. The caller still owns (and frees) the variables. */
+int  swap_put(SwapFile *s, const VarSlot vars[NUM_VAR_SLOTS]);
+/* Restores a slot into vars (long values get fresh heap copies) and
+   frees the slot. */
+void swap_get(SwapFile *s, int slot, VarSlot vars[NUM_VAR_SLOTS]);
+
+#endif /* SWAP_FILE_H */
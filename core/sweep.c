@@ -0,0 +1,202 @@
+/*  core/sweep.c  – parallel parameter sweeps over the engine  */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sweep.h"
+#include "work_pool.h"
+#include "log.h"
+
+typedef struct {
+    const SweepConfig  *cfgs;
+    const SweepOptions *opt;
+    SweepResult        *out;
+    SimContext        **ctx;       /* one per worker, reused across runs */
+} SweepJob;
+
+const char *sweep_alg_name(SCHEDULING_ALGORITHM alg)
+{
+    switch (alg) {
+    case FCFS: return "FCFS";
+    case RR:   return "RR";
+    case MLFQ: return "MLFQ";
+    }
+    return "?";
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* xorshift32; never returns 0 for a non‑zero state */
+static unsigned next_rand(unsigned *s)
+{
+    unsigned x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+/* permute arrival times among the programs of a workload */
+static void shuffle_arrivals(struct program *p, int n, unsigned seed)
+{
+    unsigned s = seed;
+    for (int i = n - 1; i > 0; i--) {
+        int j = next_rand(&s) % (unsigned)(i + 1);
+        int t = p[i].arrivalTime;
+        p[i].arrivalTime = p[j].arrivalTime;
+        p[j].arrivalTime = t;
+    }
+}
+
+static void run_one(void *arg, int task, int worker)
+{
+    SweepJob          *job = arg;
+    const SweepConfig *cfg = &job->cfgs[task];
+    SweepResult       *res = &job->out[task];
+    SimContext        *c   = job->ctx[worker];
+
+    memset(res, 0, sizeof *res);
+    res->cfg = *cfg;
+
+    if (cfg->workload < 0 || cfg->workload >= job->opt->nworkloads) {
+        LOG_ERROR("sweep: run %d: no workload %d\n", task, cfg->workload);
+        return;
+    }
+    int levels = cfg->levels ? cfg->levels : SIM_MLFQ_LEVELS;
+    if (sim_set_mlfq(c, levels, NULL) != 0) {
+        LOG_ERROR("sweep: run %d: bad MLFQ level count %d\n", task, levels);
+        return;
+    }
+    const SweepWorkload *w = &job->opt->workloads[cfg->workload];
+    struct program *progs = malloc((w->n ? w->n : 1) * sizeof *progs);
+    if (!progs) { perror("sweep"); exit(EXIT_FAILURE); }
+    memcpy(progs, w->progs, w->n * sizeof *progs);
+    if (cfg->seed) shuffle_arrivals(progs, w->n, cfg->seed);
+
+    /* every run replays the same input from the start */
+    FILE *in = NULL;
+    if (job->opt->input && job->opt->input_len)
+        in = fmemopen((void *)job->opt->input, job->opt->input_len, "r");
+    sim_set_io(c, in, NULL);
+
+    double t0 = now_us();
+    sim_init(c, progs, w->n, cfg->alg, cfg->quantum);
+    sim_run(c, NULL, &res->stats);
+    res->wall_us = now_us() - t0;
+    sim_metrics(c, &res->metrics);
+    res->cfg.levels = levels;
+    res->ok = 1;
+
+    sim_reset(c);
+    sim_set_io(c, NULL, NULL);
+    if (in) fclose(in);
+    free(progs);
+}
+
+int sweep_run(const SweepConfig *cfgs, int n, const SweepOptions *opt,
+              SweepResult *out)
+{
+    int threads = opt->threads > 0 ? opt->threads : pool_default_threads();
+    if (threads > n) threads = n;
+    if (threads <= 0) return 0;
+
+    SimContext **ctx = calloc(threads, sizeof *ctx);
+    if (!ctx) { perror("sweep"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < threads; i++)
+        if (!(ctx[i] = sim_create())) exit(EXIT_FAILURE);
+
+    SweepJob job = { cfgs, opt, out, ctx };
+    pool_run(threads, n, run_one, &job);
+
+    for (int i = 0; i < threads; i++) sim_destroy(ctx[i]);
+    free(ctx);
+
+    int ran = 0;
+    for (int i = 0; i < n; i++) ran += out[i].ok;
+    return ran;
+}
+
+/* ───────── output ───────── */
+void sweep_csv_string(FILE *f, const char *s)
+{
+    if (!s[strcspn(s, ",\"\r\n")]) {
+        fputs(s, f);
+        return;
+    }
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"') fputc('"', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+void sweep_write_csv(FILE *f, const SweepOptions *opt,
+                     const SweepResult *res, int n)
+{
+    fprintf(f, "run,alg,quantum,levels,workload,seed,ok,procs,finished,"
+               "clock,steps,ticks,wall_us,switches,cpu_util,"
+               "turnaround_mean,turnaround_p99,response_mean,response_p99\n");
+    for (int i = 0; i < n; i++) {
+        const SweepResult *r = &res[i];
+        const char *wname = (r->cfg.workload >= 0 &&
+                             r->cfg.workload < opt->nworkloads)
+                          ? opt->workloads[r->cfg.workload].name : "";
+        const SimMetrics *m = &r->metrics;
+        fprintf(f, "%d,%s,%d,%d,", i, sweep_alg_name(r->cfg.alg),
+                r->cfg.quantum, r->cfg.levels);
+        sweep_csv_string(f, wname);
+        fprintf(f, ",%u,%d,%d,%d,%d,%ld,%ld,%.1f,"
+                   "%ld,%.4f,%.2f,%d,%.2f,%d\n",
+                r->cfg.seed, r->ok,
+                r->stats.procs_total, r->stats.finished, r->stats.clock,
+                r->stats.steps, r->stats.ticks, r->wall_us,
+                m->context_switches, m->cpu_util,
+                m->turnaround.mean, m->turnaround.p99,
+                m->response.mean, m->response.p99);
+    }
+}
+
+/* workload names come from the user; escape what JSON needs escaped */
+static void json_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') fprintf(f, "\\%c", ch);
+        else if (ch < 0x20)          fprintf(f, "\\u%04x", ch);
+        else                         fputc(ch, f);
+    }
+    fputc('"', f);
+}
+
+void sweep_write_json(FILE *f, const SweepOptions *opt,
+                      const SweepResult *res, int n)
+{
+    for (int i = 0; i < n; i++) {
+        const SweepResult *r = &res[i];
+        const char *wname = (r->cfg.workload >= 0 &&
+                             r->cfg.workload < opt->nworkloads)
+                          ? opt->workloads[r->cfg.workload].name : "";
+        fprintf(f, "{\"run\":%d,\"alg\":\"%s\",\"quantum\":%d,\"levels\":%d,"
+                   "\"workload\":",
+                i, sweep_alg_name(r->cfg.alg), r->cfg.quantum, r->cfg.levels);
+        json_string(f, wname);
+        const SimMetrics *m = &r->metrics;
+        fprintf(f, ",\"seed\":%u,\"ok\":%s,\"procs\":%d,\"finished\":%d,"
+                   "\"clock\":%d,\"steps\":%ld,\"ticks\":%ld,\"wall_us\":%.1f,"
+                   "\"switches\":%ld,\"cpu_util\":%.4f,"
+                   "\"turnaround_mean\":%.2f,\"turnaround_p99\":%d,"
+                   "\"response_mean\":%.2f,\"response_p99\":%d}\n",
+                r->cfg.seed, r->ok ? "true" : "false",
+                r->stats.procs_total, r->stats.finished, r->stats.clock,
+                r->stats.steps, r->stats.ticks, r->wall_us,
+                m->context_switches, m->cpu_util,
+                m->turnaround.mean, m->turnaround.p99,
+                m->response.mean, m->response.p99);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+/*
+ * Parameter sweeps: run one simulation per configuration, spread over a
+ * work‑stealing pool, and collect one result row per run.
+ */
+#include <stdio.h>
+#include "sim.h"
+
+/* a named program list */
+typedef struct {
+    char            name[64];
+    struct program *progs;
+    int             n;
+} SweepWorkload;
+
+typedef struct {
+    SCHEDULING_ALGORITHM alg;
+    int      quantum;
+    int      levels;         /* MLFQ levels; 0 = engine default */
+    int      workload;       /* index into SweepOptions.workloads */
+    unsigned seed;           /* 0 = arrivals as listed, else shuffled */
+} SweepConfig;
+
+typedef struct {
+    SweepConfig cfg;
+    SimRunStats stats;
+    SimMetrics  metrics;
+    double      wall_us;     /* host time spent in this run */
+    int         ok;          /* 0 if the config was rejected */
+} SweepResult;
+
+typedef struct {
+    const SweepWorkload *workloads;
+    int                  nworkloads;
+    /* bytes replayed to `assign x input` in every run (may be NULL) */
+    const char          *input;
+    size_t               input_len;
+    int                  threads;    /* <= 0: one per CPU */
+} SweepOptions;
+
+/* Runs every config and fills out[i] for cfgs[i]. Returns the number of
+   configs that ran. */
+int  sweep_run(const SweepConfig *cfgs, int n, const SweepOptions *opt,
+               SweepResult *out);
+
+/* one row per result; JSON is written as one object per line */
+void sweep_write_csv (FILE *f, const SweepOptions *opt,
+                      const SweepResult *res, int n);
+void sweep_write_json(FILE *f, const SweepOptions *opt,
+                      const SweepResult *res, int n);
+
+const char *sweep_alg_name(SCHEDULING_ALGORITHM alg);
+/* one CSV field; quoted (quotes doubled) if it holds a comma, quote or
+   line break */
+void sweep_csv_string(FILE *f, const char *s);
+
+#endif /* SWEEP_H */
@@ -0,0 +1,159 @@
+/*  core/timing_wheel.c  – single‑level timing wheel with a far‑future heap  */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "timing_wheel.h"
+
+#define SLOT(t) ((t) & (WHEEL_SLOTS - 1))
+
+/* ─────── far heap (events beyond the wheel horizon) ─────── */
+static bool far_less(const WheelEvent *a, const WheelEvent *b)
+{
+    if (a->time != b->time) return a->time < b->time;
+    return a->seq < b->seq;
+}
+
+static void far_push(TimingWheel *w, WheelEvent ev)
+{
+    if (w->far_len == w->far_cap) {
+        w->far_cap = w->far_cap ? 2 * w->far_cap : 64;
+        w->far = realloc(w->far, w->far_cap * sizeof *w->far);
+        if (!w->far) { perror("timing wheel"); exit(EXIT_FAILURE); }
+    }
+    int i = w->far_len++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!far_less(&ev, &w->far[parent])) break;
+        w->far[i] = w->far[parent];
+        i = parent;
+    }
+    w->far[i] = ev;
+}
+
+static WheelEvent far_pop(TimingWheel *w)
+{
+    WheelEvent top  = w->far[0];
+    WheelEvent last = w->far[--w->far_len];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= w->far_len) break;
+        if (c + 1 < w->far_len && far_less(&w->far[c + 1], &w->far[c])) c++;
+        if (!far_less(&w->far[c], &last)) break;
+        w->far[i] = w->far[c];
+        i = c;
+    }
+    if (w->far_len) w->far[i] = last;
+    return top;
+}
+
+/* ─────── wheel slots ─────── */
+static void slot_append(TimingWheel *w, WheelEvent ev)
+{
+    if (w->free_head < 0) {
+        int old = w->cap;
+        w->cap = w->cap ? 2 * w->cap : 64;
+        w->nodes = realloc(w->nodes, w->cap * sizeof *w->nodes);
+        if (!w->nodes) { perror("timing wheel"); exit(EXIT_FAILURE); }
+        for (int i = old; i < w->cap; i++)
+            w->nodes[i].next = (i + 1 < w->cap) ? i + 1 : -1;
+        w->free_head = old;
+    }
+    int n = w->free_head;
+    w->free_head = w->nodes[n].next;
+
+    ev.next = -1;
+    w->nodes[n] = ev;
+
+    int s = SLOT(ev.time);
+    if (w->head[s] < 0) w->head[s] = n;
+    else                w->nodes[w->tail[s]].next = n;
+    w->tail[s] = n;
+    w->busy[s / 64] |= 1ull << (s % 64);
+    w->count++;
+}
+
+/* pull every far event that the horizon now covers onto the wheel */
+static void migrate(TimingWheel *w)
+{
+    while (w->far_len && w->far[0].time < w->now + WHEEL_SLOTS)
+        slot_append(w, far_pop(w));
+}
+
+/* ─────── public API ─────── */
+void wheel_init(TimingWheel *w, int now)
+{
+    memset(w, 0, sizeof *w);
+    for (int s = 0; s < WHEEL_SLOTS; s++) w->head[s] = w->tail[s] = -1;
+    w->free_head = -1;
+    w->now       = now;
+}
+
+void wheel_free(TimingWheel *w)
+{
+    free(w->nodes);
+    free(w->far);
+    wheel_init(w, 0);
+}
+
+/* events in the past are treated as due now */
+void wheel_schedule(TimingWheel *w, int time, int kind, int arg)
+{
+    WheelEvent ev = { time < w->now ? w->now : time, kind, arg, -1, w->nextSeq++ };
+    if (ev.time < w->now + WHEEL_SLOTS) slot_append(w, ev);
+    else                                far_push(w, ev);
+}
+
+/*
+ * Move the cursor forward to `now`. The caller must not skip over pending
+ * events, so this costs only the far events that come into range.
+ */
+void wheel_advance(TimingWheel *w, int now)
+{
+    if (now <= w->now) return;
+    w->now = now;
+    migrate(w);
+}
+
+/* pops the oldest event due exactly at `now`, if any */
+bool wheel_pop(TimingWheel *w, int now, WheelEvent *out)
+{
+    wheel_advance(w, now);
+    int s = SLOT(now);
+    int n = w->head[s];
+    if (n < 0 || w->nodes[n].time != now) return false;
+
+    *out = w->nodes[n];
+    w->head[s] = w->nodes[n].next;
+    if (w->head[s] < 0) {
+        w->tail[s] = -1;
+        w->busy[s / 64] &= ~(1ull << (s % 64));
+    }
+    w->nodes[n].next = w->free_head;
+    w->free_head = n;
+    w->count--;
+    return true;
+}
+
+int wheel_next_time(const TimingWheel *w)
+{
+    if (w->count == 0)
+        return w->far_len ? w->far[0].time : -1;
+
+    /* first busy slot at or after the cursor, wrapping once */
+    int start = SLOT(w->now);
+    for (int k = 0; k <= WHEEL_SLOTS / 64; k++) {
+        int word = (start / 64 + k) % (WHEEL_SLOTS / 64);
+        uint64_t bits = w->busy[word];
+        if (k == 0)                   bits &= ~0ull << (start % 64);
+        else if (k == WHEEL_SLOTS/64) bits &= (start % 64) ? ~(~0ull << (start % 64)) : 0;
+        if (bits)
+            return w->nodes[w->head[word * 64 + __builtin_ctzll(bits)]].time;
+    }
+    return -1;   /* unreachable while count > 0 */
+}
+
+bool wheel_empty(const TimingWheel *w)
+{
+    return w->count == 0 && w->far_len == 0;
+}
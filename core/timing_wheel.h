@@ -0,0 +1,50 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Timing wheel for timed engine events (swap‑ins, ...).
+ *
+ * Events due within WHEEL_SLOTS ticks of `now` sit in per‑tick FIFO slots
+ * with a bitmap of busy slots; anything further out waits in a min‑heap and
+ * is moved onto the wheel as the horizon reaches it. Events with the same
+ * time come out in the order they were scheduled.
+ */
+#define WHEEL_SLOTS 256          /* power of two */
+
+typedef enum {
+    EV_SWAP_IN                   /* arg = pid whose image is back in memory */
+} EventKind;
+
+typedef struct {
+    int      time;
+    int      kind;
+    int      arg;
+    int      next;               /* next node in the same slot, -1 = end */
+    uint64_t seq;                /* tie‑breaker for the far heap */
+} WheelEvent;
+
+typedef struct {
+    WheelEvent *nodes;           /* node pool for the slots */
+    int         cap, free_head;
+
+    int      head[WHEEL_SLOTS], tail[WHEEL_SLOTS];
+    uint64_t busy[WHEEL_SLOTS / 64];
+    int      count;              /* events currently on the wheel */
+    int      now;
+
+    WheelEvent *far;             /* min‑heap on (time, seq) */
+    int         far_len, far_cap;
+    uint64_t    nextSeq;
+} TimingWheel;
+
+void wheel_init    (TimingWheel *w, int now);
+void wheel_free    (TimingWheel *w);
+void wheel_schedule(TimingWheel *w, int time, int kind, int arg);
+void wheel_advance (TimingWheel *w, int now);
+bool wheel_pop     (TimingWheel *w, int now, WheelEvent *out);
+int  wheel_next_time(const TimingWheel *w);   /* -1 when nothing is pending */
+bool wheel_empty   (const TimingWheel *w);
+
+#endif /* TIMING_WHEEL_H */
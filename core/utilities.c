@@ -20,10 +20,133 @@ char *trim(char *s)
     return rtrim(ltrim(s)); 
 }
 
+// ——— comparator: returns true if a < b in heap order ———
+// seqno is compared modulo 2^32, which stays exact as long as no entry
+// waits through 2^31 newer enqueues on the same queue
+static inline bool lessThan(const PQNode *a, const PQNode *b) {
+    if (a->priority != b->priority)
+        return a->priority < b->priority;
+    return (int32_t)(a->seqno - b->seqno) < 0;
+}
+
+// ——— bubble `node` up from the hole at idx ———
+static void heapifyUp(MemQueue *q, int idx, PQNode node) {
+    PQNode *it = q->items;
+    while (idx > 0) {
+        int parent = (idx - 1) / 2;
+        if (!lessThan(&node, &it[parent])) break;
+        it[idx] = it[parent];
+        idx = parent;
+    }
+    it[idx] = node;
+}
+
+// ——— push `node` down from the hole at idx ———
+static void heapifyDown(MemQueue *q, int idx, PQNode node) {
+    PQNode *it = q->items;
+    int n = q->size;
+    for (;;) {
+        int child = 2*idx + 1;
+        if (child >= n) break;
+        if (child + 1 < n && lessThan(&it[child + 1], &it[child]))
+            child++;
+        if (!lessThan(&it[child], &node)) break;
+        it[idx] = it[child];
+        idx = child;
+    }
+    it[idx] = node;
+}
+
+// ——— bucket backend ———
+static void bucket_push(PQBucket *b, int pid) {
+    if (b->len == b->cap) {
+        int cap = b->cap ? 2 * b->cap : 8;
+        int32_t *ring = malloc((size_t)cap * sizeof *ring);
+        if (!ring) {
+            perror("enqueue");
+            exit(EXIT_FAILURE);
+        }
+        // unwrap into the new ring
+        for (int i = 0; i < b->len; i++)
+            ring[i] = b->ring[(b->head + i) % b->cap];
+        free(b->ring);
+        b->ring = ring;
+        b->head = 0;
+        b->cap  = cap;
+    }
+    int tail = b->head + b->len;
+    if (tail >= b->cap) tail -= b->cap;
+    b->ring[tail] = pid;
+    b->len++;
+}
+
+static int bucket_pop(PQBucket *b) {
+    int pid = b->ring[b->head];
+    if (++b->head == b->cap) b->head = 0;
+    b->len--;
+    return pid;
+}
+
+static void heap_push(MemQueue *q, int pid, int priority);
+
+// an out‑of‑range priority showed up: replay everything into the heap in
+// dequeue order, which hands out seqnos in the same FIFO order
+static void buckets_to_heap(MemQueue *q) {
+    q->kind = PQ_HEAP;
+    q->size = 0;
+    q->nextSeq = 0;
+    uint64_t bits = q->nonempty;
+    while (bits) {
+        int k = __builtin_ctzll(bits);
+        bits &= bits - 1;
+        PQBucket *b = &q->buckets[k];
+        while (b->len) heap_push(q, bucket_pop(b), q->bucket_lo + k);
+    }
+    q->nonempty = 0;
+}
+
 // Initialize empty queue
-void initQueue(MemQueue *q) {
+void initQueue(MemQueue *q, PCB *procs) {
+    memset(q, 0, sizeof *q);
+    q->kind  = PQ_HEAP;
+    q->procs = procs;
+}
+
+void clearQueue(MemQueue *q) {
     q->size    = 0;
     q->nextSeq = 0;
+    for (int k = 0; k < q->nbuckets; k++)
+        q->buckets[k].head = q->buckets[k].len = 0;
+    q->nonempty = 0;
+}
+
+void freeQueue(MemQueue *q) {
+    free(q->items);
+    for (int k = 0; k < q->nbuckets; k++)
+        free(q->buckets[k].ring);
+    free(q->buckets);
+    initQueue(q, q->procs);
+}
+
+void configureQueue(MemQueue *q, int lo, int hi) {
+    clearQueue(q);
+    int n = hi - lo + 1;
+    if (n < 1 || n > PQ_MAX_BUCKETS) {
+        q->kind = PQ_HEAP;
+        return;
+    }
+    if (n > q->nbuckets) {
+        PQBucket *b = realloc(q->buckets, (size_t)n * sizeof *b);
+        if (!b) {
+            perror("configureQueue");
+            exit(EXIT_FAILURE);
+        }
+        memset(b + q->nbuckets, 0, (size_t)(n - q->nbuckets) * sizeof *b);
+        q->buckets  = b;
+        q->nbuckets = n;
+    }
+    q->kind      = PQ_BUCKET;
+    q->bucket_lo = lo;
 }
 
 // Empty?
@@ -31,39 +154,164 @@ bool isEmpty(MemQueue *q) {
     return (q->size == 0);
 }
 
-// Full?
-bool isFull(MemQueue *q) {
-    return (q->size == MAX_QSIZE);
+static void heap_push(MemQueue *q, int pid, int priority) {
+    if (q->size == q->cap) {
+        int cap = q->cap ? 2 * q->cap : 16;
+        PQNode *items = realloc(q->items, (size_t)cap * sizeof *items);
+        if (!items) {
+            perror("enqueue");
+            exit(EXIT_FAILURE);
+        }
+        q->items = items;
+        q->cap   = cap;
+    }
+    PQNode node = { priority, q->nextSeq++, pid };
+    heapifyUp(q, q->size++, node);
 }
 
 /**
- * Enqueue a MemoryWord* with the given priority.
+ * Enqueue a pid with the given priority.
  * Lower priority value → higher scheduling priority.
- * Items with equal priority preserve FIFO via seqno.
+ * Items with equal priority preserve FIFO (seqno / bucket order).
  */
-void enqueue(MemQueue *q, struct MemoryWord *ptr, int priority) {
-    if (isFull(q)) {
-        fprintf(stderr, "PriorityQueue is full\n");
-        return;
+void enqueue_pid(MemQueue *q, int pid, int priority) {
+    if (q->watch) q->watch(q->watch_arg, q, true, pid, priority);
+    if (q->kind == PQ_BUCKET) {
+        unsigned k = (unsigned)(priority - q->bucket_lo);
+        if (k < (unsigned)q->nbuckets) {
+            bucket_push(&q->buckets[k], pid);
+            q->nonempty |= 1ull << k;
+            q->size++;
+            return;
+        }
+        buckets_to_heap(q);
+    }
+    heap_push(q, pid, priority);
+}
+
+int peek_pid(const MemQueue *q) {
+    if (q->size == 0) return -1;
+    if (q->kind == PQ_BUCKET) {
+        const PQBucket *b = &q->buckets[__builtin_ctzll(q->nonempty)];
+        return b->ring[b->head];
     }
-    PQNode *node = &q->items[q->size];
-    node->ptr      = ptr;
-    node->priority = priority;
-    node->seqno    = q->nextSeq++;
-    heapifyUp(q, q->size);
-    q->size++;
+    return q->items[0].pid;
+}
+
+int dequeue_pid(MemQueue *q) {
+    if (q->size == 0) return -1;
+    if (q->kind == PQ_BUCKET) {
+        int k = __builtin_ctzll(q->nonempty);
+        PQBucket *b = &q->buckets[k];
+        int pid = bucket_pop(b);
+        if (b->len == 0) q->nonempty &= ~(1ull << k);
+        q->size--;
+        if (q->watch) q->watch(q->watch_arg, q, false, pid, q->bucket_lo + k);
+        return pid;
+    }
+    PQNode top = q->items[0];
+    // move last node to root
+    if (--q->size > 0)
+        heapifyDown(q, 0, q->items[q->size]);
+    if (q->watch) q->watch(q->watch_arg, q, false, top.pid, top.priority);
+    return top.pid;
+}
+
+// removes items[i], keeping the heap order
+static void heap_remove_at(MemQueue *q, int i) {
+    int pid  = q->items[i].pid;
+    int prio = q->items[i].priority;
+    PQNode last = q->items[--q->size];
+    if (i < q->size) {
+        if (i > 0 && lessThan(&last, &q->items[(i - 1) / 2]))
+            heapifyUp(q, i, last);
+        else
+            heapifyDown(q, i, last);
+    }
+    if (q->watch) q->watch(q->watch_arg, q, false, pid, prio);
+}
+
+// Removes pid wherever it is; false if it is not queued. The head is the
+// O(1) case, anything else is a linear search.
+bool remove_pid(MemQueue *q, int pid) {
+    if (peek_pid(q) == pid) {
+        dequeue_pid(q);
+        return true;
+    }
+    if (q->kind == PQ_BUCKET) {
+        for (int k = 0; k < q->nbuckets; k++) {
+            PQBucket *b = &q->buckets[k];
+            for (int i = 0; i < b->len; i++) {
+                if (b->ring[(b->head + i) % b->cap] != pid) continue;
+                for (; i < b->len - 1; i++)
+                    b->ring[(b->head + i) % b->cap] =
+                        b->ring[(b->head + i + 1) % b->cap];
+                if (--b->len == 0) q->nonempty &= ~(1ull << k);
+                q->size--;
+                if (q->watch) q->watch(q->watch_arg, q, false, pid, q->bucket_lo + k);
+                return true;
+            }
+        }
+        return false;
+    }
+    for (int i = 0; i < q->size; i++)
+        if (q->items[i].pid == pid) {
+            heap_remove_at(q, i);
+            return true;
+        }
+    return false;
+}
+
+// Takes out the pid that would leave q last (the newest one of the
+// lowest priority) or, for the heap, the last leaf, which is close to
+// that and needs no fix‑up; the one before it if that is `keep`. -1 if
+// nothing but `keep` is queued.
+int steal_pid(MemQueue *q, int keep) {
+    if (q->size == 0 || (q->size == 1 && peek_pid(q) == keep)) return -1;
+    if (q->kind == PQ_HEAP) {
+        int i = q->size - 1;
+        if (q->items[i].pid == keep) i--;
+        int pid = q->items[i].pid;
+        heap_remove_at(q, i);
+        return pid;
+    }
+    uint64_t bits = q->nonempty;
+    while (bits) {
+        int k = 63 - __builtin_clzll(bits);
+        bits &= ~(1ull << k);
+        PQBucket *b = &q->buckets[k];
+        int i = b->len - 1;
+        int pid = b->ring[(b->head + i) % b->cap];
+        if (pid == keep) {
+            if (!i) continue;
+            pid = b->ring[(b->head + --i) % b->cap];
+            b->ring[(b->head + i) % b->cap] = keep;
+        }
+        if (--b->len == 0) q->nonempty &= ~(1ull << k);
+        q->size--;
+        if (q->watch) q->watch(q->watch_arg, q, false, pid, q->bucket_lo + k);
+        return pid;
+    }
+    return -1;
+}
+
+/**
+ * Enqueue a PCB* with the given priority; it must live in q->procs.
+ */
+void enqueue(MemQueue *q, PCB *ptr, int priority) {
+    enqueue_pid(q, (int)(ptr - q->procs), priority);
 }
 
 /**
  * Peek at the highest‑priority item without removing it.
- * Returns NULL (and prints) if empty.
+ * Returns NULL if empty.
  */
-struct MemoryWord* peek(MemQueue *q) {
+PCB *peek(MemQueue *q) {
     if (isEmpty(q)) {
         //fprintf(stderr, "PriorityQueue is empty\n");
         return NULL;
     }
-    return q->items[0].ptr;
+    return &q->procs[peek_pid(q)];
 }
 
 /**
@@ -75,31 +323,90 @@ int peekPriority(MemQueue *q) {
         fprintf(stderr, "PriorityQueue is empty\n");
         return -1;
     }
+    if (q->kind == PQ_BUCKET)
+        return q->bucket_lo + __builtin_ctzll(q->nonempty);
     return q->items[0].priority;
 }
 
 /**
- * Dequeue and return the highest‑priority MemoryWord*.
+ * Dequeue and return the highest‑priority PCB*.
  * Returns NULL (and prints) if empty.
  */
-struct MemoryWord* dequeue(MemQueue *q) {
+PCB *dequeue(MemQueue *q) {
     if (isEmpty(q)) {
         fprintf(stderr, "PriorityQueue is empty\n");
         return NULL;
     }
-    struct MemoryWord *top = q->items[0].ptr;
-    // move last node to root
-    q->items[0] = q->items[--q->size];
-    heapifyDown(q, 0);
-    return top;
+    return &q->procs[dequeue_pid(q)];
+}
+
+int queuePids(const MemQueue *q, int *pids, int max) {
+    int n = 0;
+    if (q->kind == PQ_HEAP) {
+        for (; n < q->size && n < max; n++)
+            pids[n] = q->items[n].pid;
+        return n;
+    }
+    uint64_t bits = q->nonempty;
+    while (bits && n < max) {
+        const PQBucket *b = &q->buckets[__builtin_ctzll(bits)];
+        bits &= bits - 1;
+        for (int i = 0; i < b->len && n < max; i++)
+            pids[n++] = b->ring[(b->head + i) % b->cap];
+    }
+    return n;
+}
+
+static int by_heap_order(const void *x, const void *y) {
+    const PQNode *a = x, *b = y;
+    return lessThan(a, b) ? -1 : lessThan(b, a);
+}
+
+int queue_pids_ordered(const MemQueue *q, int *pids, int max) {
+    if (q->kind == PQ_BUCKET || q->size < 2) return queuePids(q, pids, max);
+    PQNode *tmp = malloc((size_t)q->size * sizeof *tmp);
+    if (!tmp) {
+        perror("queue_pids_ordered");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(tmp, q->items, (size_t)q->size * sizeof *tmp);
+    qsort(tmp, q->size, sizeof *tmp, by_heap_order);
+    int n = q->size < max ? q->size : max;
+    for (int i = 0; i < n; i++) pids[i] = tmp[i].pid;
+    free(tmp);
+    return n;
+}
+
+int queue_rank(const MemQueue *q, int priority) {
+    int n = 0;
+    if (q->kind == PQ_BUCKET) {
+        int k = priority - q->bucket_lo;
+        if (k < 0)            return 0;
+        if (k >= q->nbuckets) return q->size;
+        for (uint64_t bits = q->nonempty & ((2ull << k) - 1); bits; bits &= bits - 1)
+            n += q->buckets[__builtin_ctzll(bits)].len;
+        return n;
+    }
+    for (int i = 0; i < q->size; i++)
+        n += q->items[i].priority <= priority;   /* FIFO among equals */
+    return n;
 }
 
 void printQueue(MemQueue *q, int qid) {
     printf("  [Q%d] size=%2d |", qid, q->size);
+    if (q->kind == PQ_BUCKET) {
+        for (int k = 0; k < q->nbuckets; k++) {
+            const PQBucket *b = &q->buckets[k];
+            for (int i = 0; i < b->len; i++)
+                printf(" (%d,pr=%d)", b->ring[(b->head + i) % b->cap],
+                       q->bucket_lo + k);
+        }
+        printf("\n");
+        return;
+    }
     for (int j = 0; j < q->size; ++j) {
-        struct MemoryWord *mw = q->items[j].ptr;
-        printf(" (%s,pr=%d,seq=%" PRIu64 ")",
-               mw->arg1,
+        printf(" (%d,pr=%d,seq=%" PRIu32 ")",
+               q->items[j].pid,
                q->items[j].priority,
                q->items[j].seqno);
     }
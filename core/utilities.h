@@ -7,8 +7,6 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <inttypes.h>   // for PRIu64
-#define MAX_QSIZE  60  // or whatever max you need
-#define MAX_PROGRAMS 100
 
 
 char *ltrim(char *s);
@@ -38,77 +36,153 @@ typedef enum {
     MLFQ
 } SCHEDULING_ALGORITHM;
 
+// ——— display view of one memory word ———
+// The engine never stores these: process images are rendered into words
+// on demand (sim_render_memory) for the memory dump and front‑ends.
 struct MemoryWord {
     char identifier[100];
     char arg1[100];
     int  arg2;    // you can still use this or ignore it
 };
 
+// ——— pre‑decoded program text ———
+// every line is compiled once at load time; the engine dispatches on `op`
+typedef enum {
+    OP_EOI,
+    OP_ASSIGN,            // assign a <int|"str"|var>
+    OP_ASSIGN_INPUT,      // assign a input
+    OP_ASSIGN_READFILE,   // assign a readFile f
+    OP_PRINT,             // print a
+    OP_WRITEFILE,         // writeFile f c
+    OP_READFILE,          // readFile f   (no‑op, kept for compatibility)
+    OP_PRINT_FROM_TO,     // printFromTo x y
+    OP_SEM_WAIT,          // semWait <resource>
+    OP_SEM_SIGNAL         // semSignal <resource>
+} Opcode;
+
+#define FIRST_VAR_SLOT 5   // word offset of the variables in a rendered image
+#define NUM_VAR_SLOTS  3
+
+typedef struct {
+    signed char slot;     // variable slot (0..2) if the token names a variable, else -1
+    int         ival;     // token parsed as an integer literal
+    char       *text;     // raw token (string literals already unquoted)
+} Operand;
+
+typedef struct {
+    Opcode    op;
+    Resources res;        // semWait / semSignal only
+    Operand   a, b;
+} Instruction;
+
+
+// ——— one program variable ———
+// 32 bytes: values shorter than VAR_INLINE live in the slot itself, longer
+// ones (up to 99 chars, like the old 100‑byte word) in `heap`
+#define VAR_INLINE 18
+
+typedef struct {
+    int32_t  ival;                // atoi(value), for integer operands
+    uint8_t  set;                 // assigned yet?
+    uint8_t  len;
+    char     text[VAR_INLINE];
+    char    *heap;                // NULL unless len >= VAR_INLINE
+} VarSlot;
+
+// ——— process control block ———
+// the engine reads and writes these fields directly; the five PCB words at
+// the start of a process image are only rendered from it for display
+typedef struct PCB {
+    int           pid;
+    process_state state;
+    int           priority;
+    int           pc;            // index into code[]
+    int           mem_lo, mem_hi;
+    int           mlfq_level;
+    int           rem_quantum;   // ticks left at mlfq_level (0 = fresh)
+    int           image;         // shared decoded program (context‑local index)
+    int           swap;          // 1 + swap file slot while swapped out, -1 from
+                                 // swap‑in to the next dispatch, else 0
+    Instruction  *code;          // its code, OP_EOI terminated
+    VarSlot       vars[NUM_VAR_SLOTS];
+} PCB;
 
 // ——— a node in our heap ———
+// 12 bytes: the process is named by pid (an index into the queue's process
+// table) and FIFO order among equal priorities comes from a 32‑bit ticket
 typedef struct {
-    struct MemoryWord *ptr;  // the user payload
-    int                priority;
-    uint64_t           seqno; // tie‑breaker: lower = older
+    int32_t   priority;
+    uint32_t  seqno;  // tie‑breaker: lower = older (compared wrap‑safe)
+    int32_t   pid;    // the user payload
 } PQNode;
 
-// ——— the priority queue itself ———
+// ——— one FIFO ring per priority (bucket backend) ———
 typedef struct {
-    PQNode  items[MAX_QSIZE];
-    int     size;
-    uint64_t nextSeq;  // for assigning seqno
+    int32_t *ring;      // pids, oldest at ring[head]
+    int      head, len, cap;
+} PQBucket;
+
+#define PQ_MAX_BUCKETS 64   // one bit per bucket in `nonempty`
+
+typedef enum {
+    PQ_HEAP,            // any priorities, O(log n)
+    PQ_BUCKET           // priorities in [bucket_lo, bucket_lo+nbuckets), O(1)
+} PQKind;
+
+// ——— the priority queue itself ———
+// Two interchangeable backends with the same order: lowest priority value
+// first, FIFO among equals. The heap is a binary min‑heap on (priority,
+// seqno) whose storage grows on demand; the bucket queue keeps one FIFO
+// per priority and finds the first non‑empty one with a bit scan.
+typedef struct MemQueue {
+    PQKind   kind;
+    int      size;
+    PCB     *procs;    // pid → PCB for the pointer API below
+
+    // heap
+    PQNode  *items;
+    int      cap;
+    uint32_t nextSeq;  // for assigning seqno
+
+    // buckets
+    PQBucket *buckets;
+    int       bucket_lo, nbuckets;
+    uint64_t  nonempty;
+
+    // optional observer, told about every pid that enters or leaves
+    void    (*watch)(void *arg, const struct MemQueue *q, bool added,
+                     int pid, int priority);
+    void     *watch_arg;
 } MemQueue;
 
-// ——— helper: swap two nodes ———
-static void swapNode(PQNode *a, PQNode *b) {
-    PQNode tmp = *a;
-    *a = *b;
-    *b = tmp;
-}
-
-// ——— comparator: returns true if a < b in heap order ———
-static bool lessThan(const PQNode *a, const PQNode *b) {
-    if (a->priority != b->priority)
-        return a->priority < b->priority;
-    return a->seqno < b->seqno;
-}
-
-// ——— bubble up the node at idx ———
-static void heapifyUp(MemQueue *q, int idx) {
-    if (idx == 0) return;
-    int parent = (idx - 1) / 2;
-    if (lessThan(&q->items[idx], &q->items[parent])) {
-        swapNode(&q->items[idx], &q->items[parent]);
-        heapifyUp(q, parent);
-    }
-}
-
-// ——— push down the node at idx ———
-static void heapifyDown(MemQueue *q, int idx) {
-    int smallest = idx;
-    int left  = 2*idx + 1;
-    int right = 2*idx + 2;
-
-    if (left < q->size && lessThan(&q->items[left], &q->items[smallest]))
-        smallest = left;
-    if (right < q->size && lessThan(&q->items[right], &q->items[smallest]))
-        smallest = right;
-
-    if (smallest != idx) {
-        swapNode(&q->items[idx], &q->items[smallest]);
-        heapifyDown(q, smallest);
-    }
-}
-
-
-void initQueue(MemQueue *q);
+
+void initQueue (MemQueue *q, PCB *procs);   // q must not hold storage yet
+void clearQueue(MemQueue *q);               // empty it, keep the storage
+void freeQueue (MemQueue *q);
+// Pick the backend for priorities in [lo, hi]: buckets when the range fits
+// PQ_MAX_BUCKETS, the heap otherwise. The queue must be empty. A priority
+// outside the range later on moves the queue to the heap, order intact.
+void configureQueue(MemQueue *q, int lo, int hi);
 bool isEmpty(MemQueue *q);
-bool isFull(MemQueue *q);
-void enqueue(MemQueue *q, struct MemoryWord *ptr, int priority);
-struct MemoryWord* peek(MemQueue *q);
+void enqueue(MemQueue *q, PCB *ptr, int priority);
+PCB *peek(MemQueue *q);
 int  peekPriority(MemQueue *q);
-struct MemoryWord* dequeue(MemQueue *q);
+PCB *dequeue(MemQueue *q);
 void printQueue(MemQueue *q, int qid);
+// copies up to max pids in storage order (heap array / bucket FIFOs)
+int  queuePids(const MemQueue *q, int *pids, int max);
+// the same in dequeue order (the bucket order; the heap gets sorted)
+int  queue_pids_ordered(const MemQueue *q, int *pids, int max);
+// pids that would leave q before a newcomer of this priority, which is
+// the newcomer's index in dequeue order
+int  queue_rank(const MemQueue *q, int priority);
+
+// pid‑level variants (no process table needed); -1 when empty
+void enqueue_pid(MemQueue *q, int pid, int priority);
+int  peek_pid   (const MemQueue *q);
+int  dequeue_pid(MemQueue *q);
+bool remove_pid (MemQueue *q, int pid);     // anywhere in q; false if absent
+int  steal_pid  (MemQueue *q, int keep);    // a pid from the back, not keep; -1 if none
 
 // ——— public API ———
 
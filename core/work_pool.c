@@ -0,0 +1,275 @@
+/*  core/work_pool.c  – work‑stealing pool over an index range  */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "work_pool.h"
+
+/* one slice [lo, hi) per worker; the owner pops at lo, thieves cut at hi.
+   Bounds change only under the mutex but are also peeked without it, so
+   they are stored atomically. */
+typedef struct {
+    pthread_mutex_t mtx;
+    int             lo, hi;
+} Slice;
+
+typedef struct {
+    Slice      *slices;
+    int         nthreads;
+    PoolTaskFn  fn;
+    void       *arg;
+} Pool;
+
+typedef struct {
+    Pool *pool;
+    int   id;
+} Worker;
+
+static bool take_own(Slice *s, int *task)
+{
+    bool ok = false;
+    pthread_mutex_lock(&s->mtx);
+    if (s->lo < s->hi) {
+        *task = s->lo;
+        __atomic_store_n(&s->lo, s->lo + 1, __ATOMIC_RELAXED);
+        ok = true;
+    }
+    pthread_mutex_unlock(&s->mtx);
+    return ok;
+}
+
+/* move the back half of some other slice into ours; false when all empty */
+static bool steal(Pool *p, int self)
+{
+    for (;;) {
+        /* unlocked peek to pick the victim with the most work left */
+        int victim = -1, best = 0;
+        for (int k = 1; k < p->nthreads; k++) {
+            int v = (self + k) % p->nthreads;
+            int left = __atomic_load_n(&p->slices[v].hi, __ATOMIC_RELAXED)
+                     - __atomic_load_n(&p->slices[v].lo, __ATOMIC_RELAXED);
+            if (left > best) { best = left; victim = v; }
+        }
+        if (victim < 0) return false;
+
+        Slice *vs = &p->slices[victim];
+        int lo = 0, hi = 0;
+        pthread_mutex_lock(&vs->mtx);
+        int left = vs->hi - vs->lo;
+        if (left > 0) {
+            int cut = vs->hi - (left + 1) / 2;
+            lo = cut;
+            hi = vs->hi;
+            __atomic_store_n(&vs->hi, cut, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&vs->mtx);
+        if (hi <= lo) continue;          /* lost the race, look again */
+
+        Slice *own = &p->slices[self];
+        pthread_mutex_lock(&own->mtx);
+        __atomic_store_n(&own->lo, lo, __ATOMIC_RELAXED);
+        __atomic_store_n(&own->hi, hi, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&own->mtx);
+        return true;
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    Worker *w = arg;
+    Pool   *p = w->pool;
+    int task;
+    for (;;) {
+        while (take_own(&p->slices[w->id], &task))
+            p->fn(p->arg, task, w->id);
+        if (!steal(p, w->id))
+            break;
+    }
+    return NULL;
+}
+
+int pool_default_threads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+void pool_run(int nthreads, int ntasks, PoolTaskFn fn, void *arg)
+{
+    if (ntasks <= 0) return;
+    if (nthreads <= 0)      nthreads = pool_default_threads();
+    if (nthreads > ntasks)  nthreads = ntasks;
+
+    Pool p = { calloc(nthreads, sizeof(Slice)), nthreads, fn, arg };
+    Worker   *ws  = calloc(nthreads, sizeof *ws);
+    pthread_t *tid = calloc(nthreads, sizeof *tid);
+    if (!p.slices || !ws || !tid) { perror("work pool"); exit(EXIT_FAILURE); }
+
+    for (int i = 0; i < nthreads; i++) {
+        pthread_mutex_init(&p.slices[i].mtx, NULL);
+        p.slices[i].lo = (int)((long)ntasks * i / nthreads);
+        p.slices[i].hi = (int)((long)ntasks * (i + 1) / nthreads);
+        ws[i].pool = &p;
+        ws[i].id   = i;
+    }
+
+    /* the calling thread doubles as worker 0 */
+    for (int i = 1; i < nthreads; i++)
+        if (pthread_create(&tid[i], NULL, worker_main, &ws[i]) != 0) {
+            perror("work pool");
+            exit(EXIT_FAILURE);
+        }
+    worker_main(&ws[0]);
+    for (int i = 1; i < nthreads; i++)
+        pthread_join(tid[i], NULL);
+
+    for (int i = 0; i < nthreads; i++)
+        pthread_mutex_destroy(&p.slices[i].mtx);
+    free(p.slices);
+    free(ws);
+    free(tid);
+}
+
+/* ───────── persistent team ───────── */
+#define TEAM_SPIN 4000                   /* polls before sleeping */
+
+typedef struct {
+    PoolTeam *team;
+    int       id;
+} Member;
+
+struct PoolTeam {
+    pthread_mutex_t mtx;
+    pthread_cond_t  go, idle;
+    int             nthreads;
+    pthread_t      *tid;
+    Member         *members;
+
+    /* the current batch; written before gen moves on */
+    PoolTaskFn      fn;
+    void           *arg;
+    int             ntasks;
+    int             next;                /* next task to hand out */
+    int             busy;                /* helpers still in the batch */
+    unsigned        gen;                 /* batches started */
+    bool            quit;
+};
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static void team_work(PoolTeam *t, int id)
+{
+    int task;
+    while ((task = __atomic_fetch_add(&t->next, 1, __ATOMIC_RELAXED)) < t->ntasks)
+        t->fn(t->arg, task, id);
+}
+
+static void *member_main(void *arg)
+{
+    Member   *m = arg;
+    PoolTeam *t = m->team;
+    unsigned seen = 0;
+    for (;;) {
+        for (int i = 0; i < TEAM_SPIN &&
+                        __atomic_load_n(&t->gen, __ATOMIC_ACQUIRE) == seen; i++)
+            cpu_relax();
+        pthread_mutex_lock(&t->mtx);
+        while (t->gen == seen && !t->quit)
+            pthread_cond_wait(&t->go, &t->mtx);
+        bool quit = t->quit;
+        seen = t->gen;
+        pthread_mutex_unlock(&t->mtx);
+        if (quit) return NULL;
+
+        team_work(t, m->id);
+
+        pthread_mutex_lock(&t->mtx);
+        if (__atomic_sub_fetch(&t->busy, 1, __ATOMIC_RELEASE) == 0)
+            pthread_cond_signal(&t->idle);
+        pthread_mutex_unlock(&t->mtx);
+    }
+}
+
+PoolTeam *pool_team_create(int nthreads)
+{
+    if (nthreads <= 0) nthreads = pool_default_threads();
+
+    PoolTeam *t = calloc(1, sizeof *t);
+    if (!t) { perror("work pool"); exit(EXIT_FAILURE); }
+    t->nthreads = nthreads;
+    t->tid      = calloc(nthreads, sizeof *t->tid);
+    t->members  = calloc(nthreads, sizeof *t->members);
+    if (!t->tid || !t->members) { perror("work pool"); exit(EXIT_FAILURE); }
+    pthread_mutex_init(&t->mtx, NULL);
+    pthread_cond_init(&t->go, NULL);
+    pthread_cond_init(&t->idle, NULL);
+
+    /* member 0 is whoever calls pool_team_run */
+    for (int i = 1; i < nthreads; i++) {
+        t->members[i] = (Member){ t, i };
+        if (pthread_create(&t->tid[i], NULL, member_main, &t->members[i]) != 0) {
+            perror("work pool");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return t;
+}
+
+void pool_team_destroy(PoolTeam *t)
+{
+    if (!t) return;
+    pthread_mutex_lock(&t->mtx);
+    t->quit = true;
+    pthread_cond_broadcast(&t->go);
+    pthread_mutex_unlock(&t->mtx);
+    for (int i = 1; i < t->nthreads; i++)
+        pthread_join(t->tid[i], NULL);
+
+    pthread_cond_destroy(&t->idle);
+    pthread_cond_destroy(&t->go);
+    pthread_mutex_destroy(&t->mtx);
+    free(t->members);
+    free(t->tid);
+    free(t);
+}
+
+int pool_team_threads(const PoolTeam *t)
+{
+    return t->nthreads;
+}
+
+void pool_team_run(PoolTeam *t, int ntasks, PoolTaskFn fn, void *arg)
+{
+    if (ntasks <= 0) return;
+    if (t->nthreads == 1 || ntasks == 1) {
+        for (int i = 0; i < ntasks; i++) fn(arg, i, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&t->mtx);
+    t->fn     = fn;
+    t->arg    = arg;
+    t->ntasks = ntasks;
+    t->next   = 0;
+    t->busy   = t->nthreads - 1;
+    __atomic_store_n(&t->gen, t->gen + 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&t->go);
+    pthread_mutex_unlock(&t->mtx);
+
+    team_work(t, 0);
+
+    /* every member checks in, so none is left reading this batch */
+    for (int i = 0; i < TEAM_SPIN &&
+                    __atomic_load_n(&t->busy, __ATOMIC_ACQUIRE); i++)
+        cpu_relax();
+    pthread_mutex_lock(&t->mtx);
+    while (t->busy)
+        pthread_cond_wait(&t->idle, &t->mtx);
+    pthread_mutex_unlock(&t->mtx);
+}
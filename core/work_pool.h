@@ -0,0 +1,38 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+/*
+ * A small work‑stealing pool for batches of independent tasks 0..n-1.
+ *
+ * Each worker starts with a contiguous slice of the task range and takes
+ * tasks from the front of it. A worker that runs dry steals the back half
+ * of the fullest‑looking victim's slice, so uneven task costs even out
+ * without a shared queue on the hot path.
+ */
+
+/* `worker` is 0..nthreads-1, handy for per‑thread scratch state */
+typedef void (*PoolTaskFn)(void *arg, int task, int worker);
+
+/* number of online CPUs (at least 1) */
+int pool_default_threads(void);
+
+/* Runs fn(arg, i, w) once for every i in [0, ntasks) on `nthreads`
+   threads (<= 0: one per CPU) and returns when all are done. */
+void pool_run(int nthreads, int ntasks, PoolTaskFn fn, void *arg);
+
+/*
+ * A team of threads kept between batches, for many small batches where
+ * starting threads per pool_run would cost more than the work. Tasks are
+ * handed out one at a time from a shared counter; idle members spin
+ * briefly, then sleep until the next batch.
+ */
+typedef struct PoolTeam PoolTeam;
+
+/* nthreads <= 0: one per CPU; the caller of pool_team_run is one of them */
+PoolTeam *pool_team_create (int nthreads);
+void      pool_team_destroy(PoolTeam *t);
+int       pool_team_threads(const PoolTeam *t);
+/* Runs fn(arg, i, w) once for every i in [0, ntasks) and returns when
+   all are done. One batch at a time per team. */
+void      pool_team_run(PoolTeam *t, int ntasks, PoolTaskFn fn, void *arg);
+
+#endif /* WORK_POOL_H */
@@ -0,0 +1,373 @@
+/*  core/workload.c  – workload files and the synthetic generator  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "workload.h"
+#include "utilities.h"
+
+int workload_read(const char *path, struct program **progs)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "workload: cannot open '%s'\n", path);
+        return -1;
+    }
+    struct program *v = NULL;
+    int n = 0, cap = 0;
+    char line[256];
+    while (fgets(line, sizeof line, f)) {
+        char *s = trim(line);
+        if (!*s || *s == '#') continue;
+        struct program p = {0};
+        if (sscanf(s, "%49s %d %d", p.programName, &p.priority,
+                   &p.arrivalTime) != 3) {
+            fprintf(stderr, "workload: %s: bad line '%s'\n", path, s);
+            fclose(f);
+            free(v);
+            return -1;
+        }
+        if (n == cap) {
+            cap = cap ? 2 * cap : 8;
+            v = realloc(v, cap * sizeof *v);
+            if (!v) { perror("workload"); exit(EXIT_FAILURE); }
+        }
+        v[n++] = p;
+    }
+    fclose(f);
+    *progs = v;
+    return n;
+}
+
+int workload_check(const struct program *progs, int n)
+{
+    for (int i = 0; i < n; i++)
+        if (access(progs[i].programName, R_OK) != 0) return i;
+    return -1;
+}
+
+/* ───────── synthetic workloads ───────── */
+
+static const char *res_name[NUM_RESOURCES] = { "file", "userInput", "userOutput" };
+
+void wgen_spec_default(WgenSpec *s)
+{
+    memset(s, 0, sizeof *s);
+    s->seed        = 1;
+    s->procs       = 1000;
+    s->programs    = 64;
+    s->prio_levels = 1;
+    s->len_dist    = WGEN_LEN_UNIFORM;
+    s->len_min     = 4;
+    s->len_max     = 16;
+    s->len_mean    = 8;
+    s->io_ratio    = 0.3;
+    s->res_mix[FILE_ACCESS] = 0;      /* real file traffic: opt in */
+    s->res_mix[USER_INPUT]  = 1;
+    s->res_mix[USER_OUTPUT] = 2;
+    s->contention  = 0.5;
+    snprintf(s->file, sizeof s->file, "wgen.txt");
+    s->arrivals    = WGEN_POISSON;
+    s->rate        = 0.1;
+    s->burst       = 8;
+}
+
+void wgen_spec_free(WgenSpec *s)
+{
+    free(s->trace);
+    s->trace  = NULL;
+    s->ntrace = 0;
+}
+
+/* arrival ticks, one per line */
+static int read_trace(WgenSpec *s, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "wgen: cannot open trace '%s'\n", path);
+        return -1;
+    }
+    int cap = 0, t;
+    wgen_spec_free(s);
+    while (fscanf(f, "%d", &t) == 1) {
+        if (s->ntrace == cap) {
+            cap = cap ? 2 * cap : 256;
+            s->trace = realloc(s->trace, cap * sizeof *s->trace);
+            if (!s->trace) { perror("wgen"); exit(EXIT_FAILURE); }
+        }
+        s->trace[s->ntrace++] = t;
+    }
+    fclose(f);
+    if (!s->ntrace) {
+        fprintf(stderr, "wgen: trace '%s' has no arrival ticks\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Keys: seed, procs, programs, prio (levels), len (N, A-B or geo:MEAN),
+ * io, mix (file:input:output weights), contention, file,
+ * arrive (poisson, bursty or trace:PATH), rate, burst.
+ */
+int wgen_spec_parse(WgenSpec *s, const char *arg)
+{
+    char *copy = strdup(arg), *save;
+    if (!copy) return -1;
+    int rc = 0;
+    for (char *tok = strtok_r(copy, ",", &save); tok && !rc;
+         tok = strtok_r(NULL, ",", &save)) {
+        char *v = strchr(tok, '=');
+        if (!v) { rc = -1; break; }
+        *v++ = '\0';
+        if      (!strcmp(tok, "seed"))       s->seed        = strtoul(v, NULL, 10);
+        else if (!strcmp(tok, "procs"))      s->procs       = atol(v);
+        else if (!strcmp(tok, "programs"))   s->programs    = atoi(v);
+        else if (!strcmp(tok, "prio"))       s->prio_levels = atoi(v);
+        else if (!strcmp(tok, "io"))         s->io_ratio    = atof(v);
+        else if (!strcmp(tok, "contention")) s->contention  = atof(v);
+        else if (!strcmp(tok, "rate"))       s->rate        = atof(v);
+        else if (!strcmp(tok, "burst"))      s->burst       = atof(v);
+        else if (!strcmp(tok, "file"))
+            snprintf(s->file, sizeof s->file, "%s", v);
+        else if (!strcmp(tok, "mix")) {
+            double w[NUM_RESOURCES];
+            if (sscanf(v, "%lf:%lf:%lf", &w[0], &w[1], &w[2]) != 3) rc = -1;
+            else memcpy(s->res_mix, w, sizeof w);
+        } else if (!strcmp(tok, "len")) {
+            if (!strncmp(v, "geo:", 4)) {
+                s->len_dist = WGEN_LEN_GEOMETRIC;
+                s->len_mean = atof(v + 4);
+                s->len_min  = 1;
+                s->len_max  = (int)(10 * s->len_mean) + 1;
+            } else if (sscanf(v, "%d-%d", &s->len_min, &s->len_max) == 2) {
+                s->len_dist = WGEN_LEN_UNIFORM;
+            } else {
+                s->len_dist = WGEN_LEN_FIXED;
+                s->len_min  = s->len_max = atoi(v);
+            }
+        } else if (!strcmp(tok, "arrive")) {
+            if      (!strcmp(v, "poisson"))    s->arrivals = WGEN_POISSON;
+            else if (!strcmp(v, "bursty"))     s->arrivals = WGEN_BURSTY;
+            else if (!strncmp(v, "trace:", 6)) {
+                s->arrivals = WGEN_TRACE;
+                if (read_trace(s, v + 6)) rc = -2;
+            } else rc = -1;
+        } else rc = -1;
+        if (rc == -1) fprintf(stderr, "wgen: bad setting '%s=%s'\n", tok, v);
+    }
+    free(copy);
+    return rc ? -1 : 0;
+}
+
+/* xorshift64*; never returns 0 for a non‑zero state */
+static uint64_t next_rand(uint64_t *s)
+{
+    uint64_t x = *s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *s = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/* uniform in [0, 1) */
+static double next_unit(uint64_t *s)
+{
+    return (next_rand(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int next_int(uint64_t *s, int lo, int hi)        /* lo..hi */
+{
+    return lo + (int)(next_rand(s) % (uint64_t)(hi - lo + 1));
+}
+
+/* exponential with the given mean */
+static double next_exp(uint64_t *s, double mean)
+{
+    return -mean * log(1.0 - next_unit(s));
+}
+
+static int pick_resource(const WgenSpec *sp, uint64_t *s)
+{
+    double total = 0;
+    for (int r = 0; r < NUM_RESOURCES; r++) total += sp->res_mix[r];
+    double x = next_unit(s) * total;
+    for (int r = 0; r < NUM_RESOURCES - 1; r++) {
+        if (x < sp->res_mix[r]) return r;
+        x -= sp->res_mix[r];
+    }
+    return NUM_RESOURCES - 1;
+}
+
+static int program_length(const WgenSpec *sp, uint64_t *s)
+{
+    int n = sp->len_min;
+    if (sp->len_dist == WGEN_LEN_UNIFORM)
+        n = next_int(s, sp->len_min, sp->len_max);
+    else if (sp->len_dist == WGEN_LEN_GEOMETRIC)
+        n = 1 + (int)next_exp(s, sp->len_mean - 1);
+    if (n < sp->len_min) n = sp->len_min;
+    if (n > sp->len_max) n = sp->len_max;
+    return n;
+}
+
+/* One program of exactly `len` lines. `a` is assigned first so every
+   print has something to show; the file is written before it is read. */
+static char *make_program(const WgenSpec *sp, uint64_t *s, int len)
+{
+    size_t cap = (size_t)len * 64 + 1, used = 0;
+    char *text = malloc(cap);
+    if (!text) { perror("wgen"); exit(EXIT_FAILURE); }
+#define EMIT(...) (used += snprintf(text + used, cap - used, __VA_ARGS__))
+
+    bool wrote = false;
+    EMIT("assign a %d\n", next_int(s, 1, 100));
+    for (int left = len - 1; left > 0; ) {
+        if (next_unit(s) >= sp->io_ratio) {
+            EMIT("assign b %d\n", next_int(s, 1, 100));
+            left--;
+            continue;
+        }
+        int  r    = pick_resource(sp, s);
+        bool hold = left >= 3 && next_unit(s) < sp->contention;
+        if (hold) EMIT("semWait %s\n", res_name[r]);
+        switch (r) {
+        case FILE_ACCESS:
+            if (!wrote || next_unit(s) < 0.5) {
+                EMIT("writeFile %s a\n", sp->file);
+                wrote = true;
+            } else {
+                EMIT("assign b readFile %s\n", sp->file);
+            }
+            break;
+        case USER_INPUT:
+            EMIT("assign c input\n");
+            break;
+        default:
+            if (next_unit(s) < 0.5) EMIT("print a\n");
+            else                    EMIT("printFromTo 1 %d\n", next_int(s, 1, 8));
+        }
+        if (hold) EMIT("semSignal %s\n", res_name[r]);
+        left -= hold ? 3 : 1;
+    }
+#undef EMIT
+    return text;
+}
+
+int wgen_init(Wgen *g, const WgenSpec *sp)
+{
+    memset(g, 0, sizeof *g);
+    if (sp->procs < 0 || sp->programs < 1 || sp->prio_levels < 1 ||
+        sp->len_min < 1 || sp->len_max < sp->len_min ||
+        sp->io_ratio < 0 || sp->contention < 0 ||
+        (sp->arrivals != WGEN_TRACE && sp->rate <= 0) ||
+        (sp->arrivals == WGEN_BURSTY && sp->burst < 1) ||
+        (sp->arrivals == WGEN_TRACE && sp->ntrace < 1)) {
+        fprintf(stderr, "wgen: unusable workload settings\n");
+        return -1;
+    }
+    g->spec  = *sp;
+    g->rng   = ((uint64_t)sp->seed << 32 | sp->seed) ^ 0x9E3779B97F4A7C15ULL;
+    if (!g->rng) g->rng = 1;
+
+    g->text = malloc(sp->programs * sizeof *g->text);
+    if (!g->text) { perror("wgen"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < sp->programs; i++)
+        g->text[i] = make_program(sp, &g->rng, program_length(sp, &g->rng));
+    return 0;
+}
+
+void wgen_free(Wgen *g)
+{
+    for (int i = 0; g->text && i < g->spec.programs; i++) free(g->text[i]);
+    free(g->text);
+    memset(g, 0, sizeof *g);
+}
+
+void wgen_name(const Wgen *g, int i, char *buf, size_t len)
+{
+    snprintf(buf, len, "wgen%u_%d", g->spec.seed, i);
+}
+
+void wgen_define(const Wgen *g, SimContext *c)
+{
+    char name[50];
+    for (int i = 0; i < g->spec.programs; i++) {
+        wgen_name(g, i, name, sizeof name);
+        sim_define_program(c, name, g->text[i]);
+    }
+}
+
+static int next_arrival(Wgen *g)
+{
+    const WgenSpec *sp = &g->spec;
+    switch (sp->arrivals) {
+    case WGEN_TRACE: {
+        long k = g->made;
+        int  span = sp->trace[sp->ntrace - 1] - sp->trace[0] + 1;
+        return sp->trace[k % sp->ntrace] + (int)(k / sp->ntrace) * span;
+    }
+    case WGEN_BURSTY:
+        if (g->burst_left == 0) {
+            g->t += next_exp(&g->rng, sp->burst / sp->rate);
+            g->burst_left = 1 + (int)next_exp(&g->rng, sp->burst - 1);
+            g->burst_tick = (int)g->t;
+        }
+        g->burst_left--;
+        return g->burst_tick;
+    default:
+        g->t += next_exp(&g->rng, 1 / sp->rate);
+        return (int)g->t;
+    }
+}
+
+static int next_process(Wgen *g, struct program *p)
+{
+    int prog = next_int(&g->rng, 0, g->spec.programs - 1);
+    p->priority    = next_int(&g->rng, 0, g->spec.prio_levels - 1);
+    p->arrivalTime = next_arrival(g);
+    g->made++;
+    return prog;
+}
+
+int wgen_next(Wgen *g, struct program *out, int max)
+{
+    int n = 0;
+    while (n < max && g->made < g->spec.procs) {
+        int prog = next_process(g, &out[n]);
+        wgen_name(g, prog, out[n].programName, sizeof out[n].programName);
+        n++;
+    }
+    return n;
+}
+
+int wgen_write(Wgen *g, const char *dir, FILE *f)
+{
+    char name[50], path[sizeof ((struct program *)0)->programName];
+    for (int i = 0; i < g->spec.programs; i++) {
+        wgen_name(g, i, name, sizeof name);
+        if (snprintf(path, sizeof path, "%s/%s.txt", dir, name) >= (int)sizeof path) {
+            fprintf(stderr, "wgen: '%s/%s.txt' is longer than a program name "
+                            "may be\n", dir, name);
+            return -1;
+        }
+        FILE *pf = fopen(path, "w");
+        if (!pf) {
+            fprintf(stderr, "wgen: cannot write '%s'\n", path);
+            return -1;
+        }
+        fputs(g->text[i], pf);
+        fclose(pf);
+    }
+    fprintf(f, "# wgen seed=%u procs=%ld programs=%d\n",
+            g->spec.seed, g->spec.procs, g->spec.programs);
+    struct program p;
+    while (g->made < g->spec.procs) {
+        int prog = next_process(g, &p);
+        wgen_name(g, prog, name, sizeof name);
+        fprintf(f, "%s/%s.txt %d %d\n", dir, name, p.priority, p.arrivalTime);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+/*
+ * Workloads: files listing programs, and a synthetic generator.
+ *
+ * A workload file has one program per line,
+ *     <program file> <priority> <arrival>
+ * Blank lines and lines starting with '#' are skipped.
+ */
+#include <stdio.h>
+#include "program.h"
+#include "sim.h"
+
+/* Reads path into a malloc'd list (*progs, free it). Returns the number
+   of programs, or -1 after printing what was wrong. */
+int workload_read (const char *path, struct program **progs);
+
+/* Index of the first program whose file cannot be read, or -1. The
+   engine exits on a program it cannot load; check up front. */
+int workload_check(const struct program *progs, int n);
+
+/* ——— synthetic workloads ——— */
+
+typedef enum {
+    WGEN_LEN_FIXED,           /* len_min instructions */
+    WGEN_LEN_UNIFORM,         /* len_min..len_max */
+    WGEN_LEN_GEOMETRIC        /* mean len_mean, clamped to len_min..len_max */
+} WgenLenDist;
+
+typedef enum {
+    WGEN_POISSON,             /* exponential gaps, `rate` per tick */
+    WGEN_BURSTY,              /* bursts of ~`burst` arrivals on one tick,
+                                 same long‑run rate */
+    WGEN_TRACE                /* the ticks in trace[], replayed back to back */
+} WgenArrivals;
+
+typedef struct {
+    unsigned     seed;
+    long         procs;                     /* processes to generate */
+    int          programs;                  /* distinct texts they share */
+    int          prio_levels;               /* priorities 0..prio_levels-1 */
+
+    WgenLenDist  len_dist;                  /* instructions per program */
+    int          len_min, len_max;
+    double       len_mean;
+
+    /* Instruction mix: io_ratio of the instructions do I/O (the rest
+       assign constants); res_mix weighs file, input and output among
+       them (Resources order); `contention` of the I/O instructions hold
+       their resource with semWait/semSignal. */
+    double       io_ratio;
+    double       res_mix[NUM_RESOURCES];
+    double       contention;
+    char         file[32];                  /* what file I/O reads and writes */
+
+    WgenArrivals arrivals;
+    double       rate, burst;
+    int         *trace, ntrace;             /* malloc'd; wgen_spec_free */
+} WgenSpec;
+
+/* one generator; fields are private */
+typedef struct {
+    WgenSpec  spec;
+    char    **text;                         /* program i */
+    uint64_t  rng;
+    long      made;                         /* processes handed out */
+    double    t;                            /* arrival clock */
+    int       burst_left, burst_tick;
+} Wgen;
+
+void wgen_spec_default(WgenSpec *s);
+/* Sets spec fields from "key=value,..." (see simrun's usage for keys).
+   Returns 0, or -1 after printing what was wrong. */
+int  wgen_spec_parse  (WgenSpec *s, const char *arg);
+void wgen_spec_free   (WgenSpec *s);
+
+/* Builds the program texts. Returns 0, or -1 for a spec it cannot use. */
+int  wgen_init  (Wgen *g, const WgenSpec *spec);
+void wgen_free  (Wgen *g);
+/* name of program i, as the generated workload refers to it */
+void wgen_name  (const Wgen *g, int i, char *buf, size_t len);
+/* registers every program text with the engine (sim_define_program) */
+void wgen_define(const Wgen *g, SimContext *ctx);
+/* Next processes in arrival order, at most max. Returns how many, 0 once
+   spec.procs have been generated. */
+int  wgen_next  (Wgen *g, struct program *out, int max);
+/* Writes the programs as files in dir and the whole workload, in the
+   file format above, to f. Returns 0, or -1 after printing the error. */
+int  wgen_write (Wgen *g, const char *dir, FILE *f);
+
+#endif /* WORKLOAD_H */
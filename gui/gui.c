@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sim.h"           /* the public API from step 3 */
+#include "log.h"
 
 #define COL_PID     0
 #define COL_STATE   1
@@ -14,6 +15,7 @@
 #define COL_HI      5
 
 
+static SimContext *sim;            /* the GUI drives a single engine */
 static bool sim_running = false;
 static struct program gui_progs[3] = {
     {"tmp1.txt", 0, 0},
@@ -84,12 +86,13 @@ static void populate_ui(const SimSnapshot *s)
         s->algorithm==FCFS ?"FCFS":
         s->algorithm==RR   ?"Round‑Robin":"MLFQ");
 
-    sprintf(buf,"%d", s->procs_total);
+    sprintf(buf,"%d (%d new, %d done)", s->procs_total, s->procs_new,
+            s->procs_retired);
     gtk_label_set_text(ui.lbl_total, buf);
 
     /* processes ------------------------------------------------ */
     gtk_list_store_clear(ui.proc_store);
-    for(int i=0;i<s->procs_total;i++){
+    for(int i=0;i<s->nproc;i++){
         GtkTreeIter it;
         gtk_list_store_append(ui.proc_store,&it);
         gtk_list_store_set(ui.proc_store,&it,
@@ -133,47 +136,43 @@ static void populate_ui(const SimSnapshot *s)
     }
 }
 
-/* ============  THREAD‑SAFE CALLBACK  ================ */
-static gboolean idle_apply_snapshot(gpointer data)
+/* ============  UI THREAD: pick up published state  ================ */
+static SimSnapshot   view;             /* owned by the UI thread */
+static unsigned long view_seq;
+
+static gboolean refresh_ui(gpointer data)
 {
-    SimSnapshot *snap = data;
-    populate_ui(snap);
+    unsigned long seq = sim_latest(sim, &view);   /* never blocks the engine */
+    if (!seq || seq == view_seq) return G_SOURCE_CONTINUE;
+    view_seq = seq;
+    populate_ui(&view);
 
     /* append to log */
     char line[128];
-    sprintf(line,"[C=%d] snapshot\n", snap->clock);
+    sprintf(line,"[C=%d] snapshot\n", view.clock);
     GtkTextIter end;
     gtk_text_buffer_get_end_iter(ui.log_buf,&end);
     gtk_text_buffer_insert(ui.log_buf,&end,line,-1);
-
-    free(snap);
-    return G_SOURCE_REMOVE;
+    return G_SOURCE_CONTINUE;
 }
 
 /* ============  Worker   ================ */
 static void *worker(void *arg) {
     while (worker_running) {
-        printf("[DEBUG] Worker loop started\n");
-        SimSnapshot *snap = malloc(sizeof *snap);
-        if (!snap) {
-            perror("malloc failed");
-            break;
-        }
+        LOG_DEBUG("Worker loop started\n");
 
-        int alive = sim_step(snap);
-        printf("[DEBUG] sim_step returned alive=%d\n", alive);
-
-        g_idle_add(idle_apply_snapshot, snap); // UI thread owns it
+        int alive = sim_step(sim, NULL);          /* the engine publishes */
+        LOG_DEBUG("sim_step returned alive=%d\n", alive);
 
         if (!alive) {
-            printf("[DEBUG] Simulation complete\n");
+            LOG_DEBUG("Simulation complete\n");
             worker_running = 0;
             break;
         }
 
         usleep(auto_delay_us);
     }
-    printf("[DEBUG] Worker thread exiting\n");
+    LOG_DEBUG("Worker thread exiting\n");
     return NULL;
 }
 
@@ -188,8 +187,9 @@ static void on_start(GtkButton*btn,gpointer d)
     int q = gtk_spin_button_get_value_as_int(ui.spin_quant);
 
     /* reset & init the engine on our GLOBAL gui_progs[] array */
-    sim_reset();
+    sim_reset(sim);
     sim_init(
+      sim,
       gui_progs,
       gui_nprogs,
       alg,
@@ -220,12 +220,9 @@ static void on_step(GtkButton*b,gpointer d){
         if (!sim_running) 
             return;
     
-        /* grab one snapshot from the engine */
-        SimSnapshot *snap = malloc(sizeof *snap);
-        int alive = sim_step(snap);
-    
-        /* push it back onto the UI thread */
-        g_idle_add(idle_apply_snapshot, snap);
+        /* one step; show what it published right away */
+        int alive = sim_step(sim, NULL);
+        refresh_ui(NULL);
     
         /* when the engine says “I’m done”, grey out Step again */
         if (!alive) {
@@ -235,7 +232,7 @@ static void on_step(GtkButton*b,gpointer d){
     }
 static void on_reset(GtkButton*b,gpointer d){
     on_stop(NULL,NULL);
-    sim_reset();
+    sim_reset(sim);
     gtk_text_buffer_set_text(ui.log_buf,"",0);
 }
 
@@ -415,6 +412,12 @@ static void build_ui(void)
 void gui_init(int *argc,char ***argv)
 {
     gtk_init(argc,argv);
+    sim = sim_create();
+    sim_set_publish(sim, 1);
     build_ui();
+    g_timeout_add(50, refresh_ui, NULL);   /* 20 Hz, however fast it steps */
     gtk_main();
+    on_stop(NULL,NULL);
+    sim_destroy(sim);
+    sim_snapshot_free(&view);
 }
@@ -0,0 +1,395 @@
+/* run_main.c – headless batch runner: one workload, one configuration
+ *
+ *   simrun [-a fcfs|rr|mlfq] [-q quantum] [-l levels] [-Q q0,q1,...]
+ *          [-c cores] [-j threads] [-w workload.txt | -g key=value,...]
+ *          [-i input.txt] [-M words] [-p] [-f json|csv] [-o out]
+ *          [-t trace.csv] [-P]
+ *
+ * Runs the workload to completion through the bulk stepping path and
+ * writes one stats record. The workload file format is the one sweep
+ * reads (see core/workload.h); without -w the three sample programs
+ * arriving at 0, 2 and 4 are used. -g generates a synthetic workload
+ * instead and streams it into the engine in batches, ahead of the clock
+ * (keys in wgen_spec_parse). Program output is discarded unless -p
+ * sends it to stderr; -i gives the text `assign x input` reads.
+ * -t writes every scheduling event as CSV (clock,event,pid,a,b). The
+ * record ends with the engine's metrics (sim_metrics): throughput, CPU
+ * utilization, context switches, migrations and the latency
+ * distributions, then (JSON) one entry per simulated core (-c; CSV
+ * has the core utilizations in one ';'‑separated column). -j steps the
+ * cores on that many host threads (0: one per CPU); the record is the
+ * same apart from wall_us, ticks_per_s, threads and par_ticks (ticks
+ * that went parallel). -P prints the engine's hot‑path profile to
+ * stderr at exit; the profile is only compiled into builds without
+ * -DNDEBUG (or with -DSIM_PROF=1).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include "sim.h"
+#include "sweep.h"
+#include "workload.h"
+#include "log.h"
+
+/* steps between trace drains; keeps well inside the trace ring */
+#define TRACE_CHUNK 1024
+/* generated processes handed to the engine at a time */
+#define GEN_BATCH   4096
+
+typedef struct {
+    FILE      *f;
+    uint64_t   next, lost;
+    TraceEvent buf[4096];
+} TraceOut;
+
+static void drain_trace(TraceOut *t)
+{
+    size_t n;
+    while ((n = trace_read(&t->next, t->buf, 4096, &t->lost)) > 0)
+        for (size_t i = 0; i < n; i++)
+            fprintf(t->f, "%d,%s,%d,%d,%d\n", t->buf[i].clock,
+                    trace_kind_name(t->buf[i].kind), t->buf[i].pid,
+                    t->buf[i].a, t->buf[i].b);
+}
+
+/* "1,2,4" into a malloc'd array; -1 on a bad entry */
+static int parse_quanta(const char *arg, int **out)
+{
+    int n = 1;
+    for (const char *s = arg; *s; s++) n += *s == ',';
+    int *v = malloc(n * sizeof *v);
+    if (!v) { perror("simrun"); exit(EXIT_FAILURE); }
+    char *end;
+    const char *s = arg;
+    for (int i = 0; i < n; i++) {
+        long q = strtol(s, &end, 10);
+        if (end == s || q < 1 || (*end && *end != ',')) {
+            fprintf(stderr, "simrun: bad quantum list '%s'\n", arg);
+            free(v);
+            return -1;
+        }
+        v[i] = (int)q;
+        s = end + 1;
+    }
+    *out = v;
+    return n;
+}
+
+/* Generated processes on their way into the engine. A batch never ends
+   in the middle of a tick: the trailing arrivals that share the last
+   tick wait for the next batch, so the engine (which stops at that tick)
+   never admits a tick before all of it has been submitted. */
+typedef struct {
+    Wgen            g;
+    struct program *buf;
+    int             len, held;           /* to submit; held back after */
+} Feed;
+
+static int feed_next(Feed *f)
+{
+    memmove(f->buf, f->buf + f->len, f->held * sizeof *f->buf);
+    int n = f->held + wgen_next(&f->g, f->buf + f->held, GEN_BATCH - f->held);
+    int keep = 0;
+    if (f->g.made < f->g.spec.procs) {        /* more to come */
+        int t = f->buf[n - 1].arrivalTime;
+        while (keep < n && f->buf[n - 1 - keep].arrivalTime == t) keep++;
+        if (keep == n) keep = 0;              /* one tick fills the batch */
+    }
+    f->len  = n - keep;
+    f->held = keep;
+    return f->len;
+}
+
+/* run_until stop: after `limit` steps, or once the clock reaches the
+   last submitted arrival so the next batch is not late */
+typedef struct {
+    long limit;
+    int  horizon;
+} StopAt;
+
+static int stop_at(const SimRunStats *so_far, void *arg)
+{
+    const StopAt *s = arg;
+    return (s->limit > 0 && so_far->steps >= s->limit) ||
+           so_far->clock >= s->horizon;
+}
+
+/* latency distributions in the stats record */
+static const char *const lat_name[4] = {
+    "turnaround", "response", "ready_wait", "blocked_wait"
+};
+
+static const SimLatency *lat_of(const SimMetrics *m, int i)
+{
+    const SimLatency *l[4] = {
+        &m->turnaround, &m->response, &m->ready_wait, &m->blocked_wait
+    };
+    return l[i];
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: simrun [-a fcfs|rr|mlfq] [-q quantum] [-l levels] [-Q quanta]\n"
+        "              [-c cores] [-j threads] [-w workload | -g spec] [-i input]\n"
+        "              [-M words] [-p]\n"
+        "              [-f json|csv] [-o out] [-t trace.csv] [-P]\n"
+        "  -g keys: seed procs programs prio len=N|A-B|geo:MEAN io\n"
+        "           mix=FILE:INPUT:OUTPUT contention file\n"
+        "           arrive=poisson|bursty|trace:PATH rate burst\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    static struct program sample[3] = {
+        {"Program_1.txt", 0, 0},
+        {"Program_2.txt", 0, 2},
+        {"Program_3.txt", 0, 4}
+    };
+    SCHEDULING_ALGORITHM alg = FCFS;
+    int quantum = 2, levels = SIM_MLFQ_LEVELS, nquanta = 0, mem_words = 0;
+    int cores = 1, threads = 1;
+    int *quanta = NULL, json = 1, echo = 0, prof = 0;
+    const char *wl_path = NULL, *input_path = NULL;
+    const char *out_path = NULL, *trace_path = NULL;
+    WgenSpec spec;
+    bool gen = false;
+    wgen_spec_default(&spec);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "a:q:l:Q:c:j:w:g:i:M:pf:o:t:Ph")) != -1) {
+        switch (opt) {
+        case 'a':
+            if      (!strcasecmp(optarg, "fcfs")) alg = FCFS;
+            else if (!strcasecmp(optarg, "rr"))   alg = RR;
+            else if (!strcasecmp(optarg, "mlfq")) alg = MLFQ;
+            else usage();
+            break;
+        case 'q': quantum   = atoi(optarg);                       break;
+        case 'l': levels    = atoi(optarg);                       break;
+        case 'Q':
+            free(quanta);
+            if ((nquanta = parse_quanta(optarg, &quanta)) < 0) usage();
+            break;
+        case 'c': cores      = atoi(optarg);                      break;
+        case 'j': threads    = atoi(optarg);                      break;
+        case 'w': wl_path    = optarg;                            break;
+        case 'g':
+            if (wgen_spec_parse(&spec, optarg)) usage();
+            gen = true;
+            break;
+        case 'i': input_path = optarg;                            break;
+        case 'M': mem_words  = atoi(optarg);                      break;
+        case 'p': echo = 1;                                       break;
+        case 'f':
+            if      (!strcasecmp(optarg, "json")) json = 1;
+            else if (!strcasecmp(optarg, "csv"))  json = 0;
+            else usage();
+            break;
+        case 'o': out_path   = optarg;                            break;
+        case 't': trace_path = optarg;                            break;
+        case 'P': prof = 1;                                       break;
+        default:  usage();
+        }
+    }
+    if (quantum < 1) usage();
+    if (nquanta) levels = nquanta;
+
+    struct program *progs = sample;
+    int n = 3;
+    Feed feed = {0};
+    if (gen) {
+        if (wgen_init(&feed.g, &spec)) return EXIT_FAILURE;
+        feed.buf = progs = malloc(GEN_BATCH * sizeof *progs);
+        if (!progs) { perror("simrun"); return EXIT_FAILURE; }
+        n = feed_next(&feed);
+    } else if (wl_path && (n = workload_read(wl_path, &progs)) < 0) {
+        return EXIT_FAILURE;
+    }
+    int bad = gen ? -1 : workload_check(progs, n);
+    if (bad >= 0) {
+        fprintf(stderr, "simrun: cannot read program '%s'\n",
+                progs[bad].programName);
+        return EXIT_FAILURE;
+    }
+
+    SimContext *c = sim_create();
+    if (!c) return EXIT_FAILURE;
+    if (sim_set_mlfq(c, levels, quanta) != 0) {
+        fprintf(stderr, "simrun: bad MLFQ configuration\n");
+        return EXIT_FAILURE;
+    }
+    if (sim_set_cores(c, cores) != 0) {
+        fprintf(stderr, "simrun: bad core count %d\n", cores);
+        return EXIT_FAILURE;
+    }
+    if (sim_set_threads(c, threads) != 0) {
+        fprintf(stderr, "simrun: bad thread count %d\n", threads);
+        return EXIT_FAILURE;
+    }
+    if (mem_words && sim_set_memory(c, mem_words, ALLOC_FIRST_FIT, true) != 0) {
+        fprintf(stderr, "simrun: bad memory size %d\n", mem_words);
+        return EXIT_FAILURE;
+    }
+    FILE *in = NULL;
+    if (input_path && !(in = fopen(input_path, "r"))) {
+        fprintf(stderr, "simrun: cannot read input '%s'\n", input_path);
+        return EXIT_FAILURE;
+    }
+    sim_set_io(c, in, echo ? stderr : NULL);
+    if (gen) wgen_define(&feed.g, c);
+
+    TraceOut *trace = NULL;
+    if (trace_path) {
+        trace = calloc(1, sizeof *trace);
+        if (!trace || !(trace->f = fopen(trace_path, "w"))) {
+            fprintf(stderr, "simrun: cannot write trace '%s'\n", trace_path);
+            return EXIT_FAILURE;
+        }
+        fprintf(trace->f, "clock,event,pid,a,b\n");
+        trace_clear();
+        trace_enable(true);
+    }
+
+    log_set_level(LOG_LEVEL_ERROR);
+
+    double t0 = now_us();
+    sim_init(c, progs, n, alg, quantum);
+    SimRunStats st;
+    if (!trace && !gen) {
+        sim_run(c, NULL, &st);
+    } else {
+        StopAt at = { trace ? TRACE_CHUNK : 0,
+                      gen && n ? progs[n - 1].arrivalTime : INT_MAX };
+        long steps = 0;
+        int alive = 1;
+        for (;;) {
+            st.clock = 0;
+            alive = sim_run_until(c, stop_at, &at, NULL, &st);
+            steps += st.steps;
+            if (trace) drain_trace(trace);
+            if (gen && st.clock >= at.horizon) {
+                int more = feed_next(&feed);
+                if (more) {
+                    sim_submit(c, progs, more);
+                    at.horizon = progs[more - 1].arrivalTime;
+                    n += more;
+                    continue;
+                }
+                at.horizon = INT_MAX;
+            }
+            if (!alive) break;
+        }
+        st.steps = steps;
+        st.ticks = st.clock;                  /* the clock starts at 0 */
+    }
+    double wall_us = now_us() - t0;
+
+    SimMemStats ms;
+    sim_mem_stats(c, &ms);
+    SimMetrics mt;
+    sim_metrics(c, &mt);
+    SimCoreStats *cs = malloc(mt.cores * sizeof *cs);
+    if (!cs) { perror("simrun"); return EXIT_FAILURE; }
+    sim_core_stats(c, cs, mt.cores);
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        fprintf(stderr, "simrun: cannot write '%s'\n", out_path);
+        return EXIT_FAILURE;
+    }
+    const char *wname = gen ? "generated" : wl_path ? wl_path : "sample";
+    double tps = wall_us > 0 ? st.ticks / (wall_us / 1e6) : 0;
+    if (json) {
+        fprintf(out, "{\"alg\":\"%s\",\"quantum\":%d,\"levels\":%d,"
+                     "\"workload\":\"",
+                sweep_alg_name(alg), quantum, levels);
+        for (const char *s = wname; *s; s++) {
+            if (*s == '"' || *s == '\\') fputc('\\', out);
+            fputc(*s, out);
+        }
+        fprintf(out, "\",\"procs\":%d,\"finished\":%d,\"rejected\":%d,"
+                     "\"clock\":%d,\"steps\":%ld,\"ticks\":%ld,"
+                     "\"wall_us\":%.1f,\"ticks_per_s\":%.0f,"
+                     "\"threads\":%d,\"par_ticks\":%ld,"
+                     "\"compactions\":%ld,\"delayed\":%ld,"
+                     "\"throughput\":%.6f,\"cpu_util\":%.4f,\"switches\":%ld,"
+                     "\"cores\":%d,\"migrations\":%ld",
+                st.procs_total, st.finished, ms.rejected, st.clock,
+                st.steps, st.ticks, wall_us, tps, mt.threads, mt.par_ticks,
+                ms.compactions, ms.delayed,
+                mt.throughput, mt.cpu_util, mt.context_switches,
+                mt.cores, mt.migrations);
+        for (int i = 0; i < 4; i++) {
+            const SimLatency *l = lat_of(&mt, i);
+            fprintf(out, ",\"%s\":{\"mean\":%.2f,\"p50\":%d,\"p99\":%d,"
+                         "\"p999\":%d,\"max\":%d}",
+                    lat_name[i], l->mean, l->p50, l->p99, l->p999, l->max);
+        }
+        fprintf(out, ",\"core\":[");
+        for (int i = 0; i < mt.cores; i++)
+            fprintf(out, "%s{\"util\":%.4f,\"busy\":%ld,\"switches\":%ld,"
+                         "\"migrations\":%ld}", i ? "," : "",
+                    cs[i].utilization, cs[i].busy_ticks,
+                    cs[i].context_switches, cs[i].migrations);
+        fprintf(out, "]}\n");
+    } else {
+        fprintf(out, "alg,quantum,levels,workload,procs,finished,rejected,"
+                     "clock,steps,ticks,wall_us,ticks_per_s,threads,par_ticks,"
+                     "compactions,"
+                     "delayed,throughput,cpu_util,switches,cores,migrations");
+        for (int i = 0; i < 4; i++)
+            fprintf(out, ",%s_mean,%s_p50,%s_p99,%s_p999,%s_max", lat_name[i],
+                    lat_name[i], lat_name[i], lat_name[i], lat_name[i]);
+        fprintf(out, ",core_util");
+        fprintf(out, "\n%s,%d,%d,", sweep_alg_name(alg), quantum, levels);
+        sweep_csv_string(out, wname);
+        fprintf(out, ",%d,%d,%d,%d,%ld,%ld,%.1f,%.0f,%d,%ld,%ld,%ld,"
+                     "%.6f,%.4f,%ld,%d,%ld",
+                st.procs_total, st.finished, ms.rejected, st.clock,
+                st.steps, st.ticks, wall_us, tps, mt.threads, mt.par_ticks,
+                ms.compactions, ms.delayed,
+                mt.throughput, mt.cpu_util, mt.context_switches,
+                mt.cores, mt.migrations);
+        for (int i = 0; i < 4; i++) {
+            const SimLatency *l = lat_of(&mt, i);
+            fprintf(out, ",%.2f,%d,%d,%d,%d",
+                    l->mean, l->p50, l->p99, l->p999, l->max);
+        }
+        for (int i = 0; i < mt.cores; i++)
+            fprintf(out, "%c%.4f", i ? ';' : ',', cs[i].utilization);
+        fprintf(out, "\n");
+    }
+    if (out != stdout) fclose(out);
+    free(cs);
+    if (prof) sim_profile_dump(c, stderr);
+
+    if (trace) {
+        trace_enable(false);
+        drain_trace(trace);
+        if (trace->lost)
+            fprintf(stderr, "simrun: trace lost %llu events\n",
+                    (unsigned long long)trace->lost);
+        fclose(trace->f);
+        free(trace);
+    }
+    sim_destroy(c);
+    if (in) fclose(in);
+    if (progs != sample) free(progs);
+    if (gen) wgen_free(&feed.g);
+    wgen_spec_free(&spec);
+    free(quanta);
+    return st.finished + ms.rejected == n ? EXIT_SUCCESS : EXIT_FAILURE;
+}
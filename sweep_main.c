@@ -0,0 +1,239 @@
+/* sweep_main.c – run a grid of scheduler configurations in parallel
+ *
+ *   sweep [-j threads] [-a fcfs,rr,mlfq] [-q 1-10] [-l 4] [-s 0-99]
+ *         [-w workload.txt]... [-i input.txt] [-f csv|json] [-o out]
+ *
+ * Every combination of algorithm × quantum × levels × workload × seed is
+ * one run. A workload file lists one program per line:
+ *     <program file> <priority> <arrival>
+ * Without -w the three sample programs arriving at 0, 2 and 4 are used.
+ * -i gives the text replayed to `assign x input` at the start of each run.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include "sweep.h"
+#include "work_pool.h"
+#include "workload.h"
+#include "log.h"
+
+typedef struct {
+    int *v;
+    int  n, cap;
+} IntList;
+
+static void push(IntList *l, int x)
+{
+    if (l->n == l->cap) {
+        l->cap = l->cap ? 2 * l->cap : 16;
+        l->v = realloc(l->v, l->cap * sizeof *l->v);
+        if (!l->v) { perror("sweep"); exit(EXIT_FAILURE); }
+    }
+    l->v[l->n++] = x;
+}
+
+/* "1,2,4" or "1-10" or a mix: "1-3,8" */
+static int parse_ints(const char *arg, IntList *l)
+{
+    char *copy = strdup(arg), *save;
+    if (!copy) { perror("sweep"); exit(EXIT_FAILURE); }
+    for (char *tok = strtok_r(copy, ",", &save); tok;
+         tok = strtok_r(NULL, ",", &save)) {
+        char *end;
+        long lo = strtol(tok, &end, 10), hi = lo;
+        if (*end == '-') hi = strtol(end + 1, &end, 10);
+        if (*end || end == tok || hi < lo) {
+            fprintf(stderr, "sweep: bad range '%s'\n", tok);
+            free(copy);
+            return -1;
+        }
+        for (long x = lo; x <= hi; x++) push(l, (int)x);
+    }
+    free(copy);
+    return 0;
+}
+
+static int parse_algs(const char *arg, IntList *l)
+{
+    char *copy = strdup(arg), *save;
+    if (!copy) { perror("sweep"); exit(EXIT_FAILURE); }
+    for (char *tok = strtok_r(copy, ",", &save); tok;
+         tok = strtok_r(NULL, ",", &save)) {
+        if      (!strcasecmp(tok, "fcfs")) push(l, FCFS);
+        else if (!strcasecmp(tok, "rr"))   push(l, RR);
+        else if (!strcasecmp(tok, "mlfq")) push(l, MLFQ);
+        else {
+            fprintf(stderr, "sweep: unknown algorithm '%s'\n", tok);
+            free(copy);
+            return -1;
+        }
+    }
+    free(copy);
+    return 0;
+}
+
+static int load_workload(const char *path, SweepWorkload *w)
+{
+    snprintf(w->name, sizeof w->name, "%s", path);
+    w->progs = NULL;
+    w->n = workload_read(path, &w->progs);
+    return w->n < 0 ? -1 : 0;
+}
+
+/* the engine exits on a program it cannot load; catch that up front */
+static int check_workload(const SweepWorkload *w)
+{
+    int bad = workload_check(w->progs, w->n);
+    if (bad < 0) return 0;
+    fprintf(stderr, "sweep: %s: cannot read program '%s'\n",
+            w->name, w->progs[bad].programName);
+    return -1;
+}
+
+static char *slurp(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    size_t cap = 4096, n = 0, got;
+    char *buf = malloc(cap);
+    while (buf && (got = fread(buf + n, 1, cap - n, f)) > 0) {
+        n += got;
+        if (n == cap) buf = realloc(buf, cap *= 2);
+    }
+    fclose(f);
+    *len = n;
+    return buf;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: sweep [-j threads] [-a fcfs,rr,mlfq] [-q quanta] [-l levels]\n"
+        "             [-s seeds] [-w workload]... [-i input] [-f csv|json]\n"
+        "             [-o out]\n"
+        "  lists are comma separated and may contain ranges, e.g. -q 1-10,16\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    static struct program sample[3] = {
+        {"Program_1.txt", 0, 0},
+        {"Program_2.txt", 0, 2},
+        {"Program_3.txt", 0, 4}
+    };
+    IntList algs = {0}, quanta = {0}, levels = {0}, seeds = {0};
+    SweepWorkload *wl = NULL;
+    int nwl = 0, threads = 0, json = 0;
+    const char *input_path = NULL, *out_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:a:q:l:s:w:i:f:o:h")) != -1) {
+        switch (opt) {
+        case 'j': threads = atoi(optarg);                        break;
+        case 'a': if (parse_algs(optarg, &algs))   usage();     break;
+        case 'q': if (parse_ints(optarg, &quanta)) usage();     break;
+        case 'l': if (parse_ints(optarg, &levels)) usage();     break;
+        case 's': if (parse_ints(optarg, &seeds))  usage();     break;
+        case 'w':
+            wl = realloc(wl, (nwl + 1) * sizeof *wl);
+            if (!wl || load_workload(optarg, &wl[nwl])) exit(EXIT_FAILURE);
+            nwl++;
+            break;
+        case 'i': input_path = optarg;                           break;
+        case 'f':
+            if      (!strcasecmp(optarg, "json")) json = 1;
+            else if (!strcasecmp(optarg, "csv"))  json = 0;
+            else usage();
+            break;
+        case 'o': out_path = optarg;                             break;
+        default:  usage();
+        }
+    }
+
+    if (!algs.n)   { push(&algs, FCFS); push(&algs, RR); push(&algs, MLFQ); }
+    if (!quanta.n) push(&quanta, 2);
+    if (!levels.n) push(&levels, 0);
+    if (!seeds.n)  push(&seeds, 0);
+    if (!nwl) {
+        wl = calloc(1, sizeof *wl);
+        snprintf(wl->name, sizeof wl->name, "sample");
+        wl->progs = sample;
+        wl->n = 3;
+        nwl = 1;
+    }
+
+    for (int w = 0; w < nwl; w++)
+        if (check_workload(&wl[w])) return EXIT_FAILURE;
+
+    SweepOptions so = { wl, nwl, NULL, 0, threads };
+    char *input = NULL;
+    if (input_path) {
+        input = slurp(input_path, &so.input_len);
+        if (!input) {
+            fprintf(stderr, "sweep: cannot read input '%s'\n", input_path);
+            return EXIT_FAILURE;
+        }
+        so.input = input;
+    }
+
+    /* expand the grid; FCFS ignores the quantum and levels, so it only
+       gets one run per workload and seed */
+    long total = (long)algs.n * quanta.n * levels.n * nwl * seeds.n;
+    SweepConfig *cfgs = malloc(total * sizeof *cfgs);
+    if (!cfgs) { perror("sweep"); return EXIT_FAILURE; }
+    int n = 0;
+    for (int a = 0; a < algs.n; a++)
+        for (int q = 0; q < quanta.n; q++)
+            for (int l = 0; l < levels.n; l++)
+                for (int w = 0; w < nwl; w++)
+                    for (int s = 0; s < seeds.n; s++) {
+                        SCHEDULING_ALGORITHM alg = algs.v[a];
+                        if (alg != RR   && q) continue;
+                        if (alg != MLFQ && l) continue;
+                        cfgs[n++] = (SweepConfig){
+                            alg, quanta.v[q], levels.v[l], w,
+                            (unsigned)seeds.v[s] };
+                    }
+
+    SweepResult *res = malloc(n * sizeof *res);
+    if (!res) { perror("sweep"); return EXIT_FAILURE; }
+
+    /* simulated programs print nothing; keep the engine's chatter down */
+    log_set_level(LOG_LEVEL_ERROR);
+
+    double t0 = now_s();
+    int ran = sweep_run(cfgs, n, &so, res);
+    double secs = now_s() - t0;
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        fprintf(stderr, "sweep: cannot write '%s'\n", out_path);
+        return EXIT_FAILURE;
+    }
+    if (json) sweep_write_json(out, &so, res, n);
+    else      sweep_write_csv (out, &so, res, n);
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "sweep: %d/%d runs in %.3f s on %d threads\n",
+            ran, n, secs, threads > 0 ? threads : pool_default_threads());
+
+    free(res);
+    free(cfgs);
+    free(input);
+    for (int w = 0; w < nwl; w++)
+        if (wl[w].progs != sample) free(wl[w].progs);
+    free(wl);
+    free(algs.v); free(quanta.v); free(levels.v); free(seeds.v);
+    return ran == n ? EXIT_SUCCESS : EXIT_FAILURE;
+}